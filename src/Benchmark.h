@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#pragma once
+
+#if (!Benchmark_H)
+#define Benchmark_H
+
+#include "Types.h"
+
+namespace Graph
+{
+	namespace Benchmark
+	{
+		// Clique -bench pool [iterations]
+		int RunPool(int argc, char* argv[]);
+
+		// Clique -bench dimacs [-dir path] [-graphs quick|all|name,prefix*,...] [-repeat n] [-out file.json] [-baseline file.json] [-threshold pct] [-min-ms ms]
+		int RunDimacs(int argc, char* argv[]);
+
+		// Clique -bench kernels [-kernels name,...] [-sizes bits,...] [-densities d,...] [-threads n] [-ws KB] [-max-graph vertices] [-ms ms]
+		int RunKernels(int argc, char* argv[]);
+	}
+}
+
+#endif
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "Benchmark.h"
+#include "GraphUtility.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace Graph
+{
+	namespace Benchmark
+	{
+		struct DimacsInstance
+		{
+			const char	*Name;
+			ID				Omega;			// known clique number.
+			bool			IsQuick;		// part of the default subset; about two seconds or less each.
+		};
+
+		static const DimacsInstance s_DimacsInstances[] =
+		{
+			{ "MANN_a9", 16, true },			{ "MANN_a27", 126, false },		{ "MANN_a45", 345, false },		{ "MANN_a81", 1100, false },
+			{ "brock200_1", 21, false },		{ "brock200_2", 12, true },		{ "brock200_3", 15, true },		{ "brock200_4", 17, true },
+			{ "brock400_1", 27, false },		{ "brock400_2", 29, false },		{ "brock400_3", 31, false },		{ "brock400_4", 33, false },
+			{ "brock800_1", 23, false },		{ "brock800_2", 24, false },		{ "brock800_3", 25, false },		{ "brock800_4", 26, false },
+			{ "c-fat200-1", 12, true },		{ "c-fat200-2", 24, true },		{ "c-fat200-5", 58, true },
+			{ "c-fat500-1", 14, true },		{ "c-fat500-2", 26, true },		{ "c-fat500-5", 64, true },		{ "c-fat500-10", 126, true },
+			{ "hamming6-2", 32, true },		{ "hamming6-4", 4, true },		{ "hamming8-2", 128, true },		{ "hamming8-4", 16, true },
+			{ "hamming10-2", 512, false },		{ "hamming10-4", 40, false },
+			{ "johnson8-2-4", 4, true },		{ "johnson8-4-4", 14, true },		{ "johnson16-2-4", 8, true },		{ "johnson32-2-4", 16, false },
+			{ "keller4", 11, true },			{ "keller5", 27, false },			{ "keller6", 59, false },
+			{ "p_hat300-1", 8, true },		{ "p_hat300-2", 25, true },		{ "p_hat300-3", 36, false },
+			{ "p_hat500-1", 9, true },		{ "p_hat500-2", 36, false },		{ "p_hat500-3", 50, false },
+			{ "p_hat700-1", 11, true },		{ "p_hat700-2", 44, false },		{ "p_hat700-3", 62, false },
+			{ "p_hat1000-1", 10, false },		{ "p_hat1000-2", 46, false },		{ "p_hat1000-3", 68, false },
+			{ "p_hat1500-1", 12, false },		{ "p_hat1500-2", 65, false },		{ "p_hat1500-3", 94, false },
+			{ "san200_0.7_1", 30, true },		{ "san200_0.7_2", 18, true },
+			{ "san200_0.9_1", 70, true },		{ "san200_0.9_2", 60, false },		{ "san200_0.9_3", 44, false },
+			{ "san400_0.5_1", 13, true },		{ "san400_0.7_1", 40, false },		{ "san400_0.7_2", 30, false },		{ "san400_0.7_3", 22, false },
+			{ "san400_0.9_1", 100, false },	{ "san1000", 15, true },
+			{ "sanr200_0.7", 18, true },		{ "sanr200_0.9", 42, false },		{ "sanr400_0.5", 13, false },		{ "sanr400_0.7", 21, false },
+		};
+
+		struct DimacsResult
+		{
+			const DimacsInstance	*Instance;
+			ID							Vertices, Found;
+			UInt64					Nodes;
+			std::vector<double>	Times;			// ms, one per repetition.
+			double					MinimumMs, MedianMs;
+			std::string				Counters;		// Clique::ExportCounters() json.
+		};
+
+		struct BaselineEntry
+		{
+			std::string	Name;
+			double		MedianMs;
+			UInt64		Nodes;
+		};
+
+		// "all", "quick" or comma separated names; a trailing '*' matches a prefix.
+		static bool IsSelected(const DimacsInstance& _instance, const char* _selection)
+		{
+			if (strcmp(_selection, "all") == 0)
+				return true;
+
+			if (strcmp(_selection, "quick") == 0)
+				return _instance.IsQuick;
+
+			std::string list(_selection);
+			size_t start = 0;
+			while (start <= list.size())
+			{
+				auto end = list.find(',', start);
+				if (end == std::string::npos)
+					end = list.size();
+
+				auto item = list.substr(start, end - start);
+				if (!item.empty() && (item.back() == '*') ? (strncmp(_instance.Name, item.c_str(), item.size() - 1) == 0) : (item == _instance.Name))
+					return true;
+
+				start = end + 1;
+			}
+
+			return false;
+		}
+
+		static bool RunInstance(const DimacsInstance& _instance, const std::string& _directory, UInt32 _repeat, DimacsResult& _result)
+		{
+			auto path = _directory + "/" + _instance.Name + ".clq.b";
+			auto graph = ReadDIMACSGraph(path.c_str());
+			if (graph.size() == 0)
+				return false;
+
+			Clique::Solver solver((decltype(Vertex::Id))graph.size());
+
+			_result.Instance = &_instance;
+			_result.Vertices = (ID)graph.size();
+			_result.Found = 0;
+			_result.Nodes = 0;
+			_result.Times.clear();
+
+			for (UInt32 i = 0; i < _repeat; i++)
+			{
+				auto start = std::chrono::steady_clock::now();
+				_result.Found = solver.FindClique(graph);
+				_result.Times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+				_result.Nodes = solver.Calls();
+			}
+
+			_result.Counters = solver.ExportCounters(Clique::CounterFormat::Json, _instance.Name);
+			FreeGraph(graph);
+
+			std::vector<double> times(_result.Times);
+			std::sort(times.begin(), times.end());
+			_result.MinimumMs = times[0];
+			_result.MedianMs = times[times.size() / 2];
+
+			return true;
+		}
+
+		static void WriteJson(FILE* _file, const std::vector<DimacsResult>& _results, UInt32 _repeat)
+		{
+			fprintf(_file, "{\"suite\":\"dimacs\",\"repeat\":%u,\"results\":[\n", _repeat);
+			for (size_t i = 0; i < _results.size(); i++)
+			{
+				auto& result = _results[i];
+				fprintf(_file, "{\"graph\":\"%s\",\"vertices\":%u,\"omega\":%u,\"found\":%u,\"ok\":%s,\"nodes\":%llu,\"min_ms\":%.3f,\"median_ms\":%.3f,\"times_ms\":[",
+					result.Instance->Name, (unsigned)result.Vertices, (unsigned)result.Instance->Omega, (unsigned)result.Found,
+					(result.Found == result.Instance->Omega) ? "true" : "false", result.Nodes, result.MinimumMs, result.MedianMs);
+
+				for (size_t j = 0; j < result.Times.size(); j++)
+					fprintf(_file, (j == 0) ? "%.3f" : ",%.3f", result.Times[j]);
+
+				fprintf(_file, "],\n\"counters\":%s}%s\n", result.Counters.c_str(), (i + 1 < _results.size()) ? "," : "");
+			}
+
+			fprintf(_file, "]}\n");
+		}
+
+		// Position of the value of "_name" at or after _pos, within _end; npos if absent.
+		static size_t FindValue(const std::string& _text, const char* _name, size_t _pos, size_t _end)
+		{
+			auto key = std::string("\"") + _name + "\"";
+			auto pos = _text.find(key, _pos);
+			if ((pos == std::string::npos) || (pos >= _end))
+				return std::string::npos;
+
+			pos += key.size();
+			while ((pos < _text.size()) && ((_text[pos] == ' ') || (_text[pos] == ':') || (_text[pos] == '\t') || (_text[pos] == '\r') || (_text[pos] == '\n')))
+				pos++;
+
+			return pos;
+		}
+
+		// Reads the "graph", "median_ms" and "nodes" fields of each result written by WriteJson(); whitespace may differ.
+		static bool ReadBaseline(const char* _path, std::vector<BaselineEntry>& _entries)
+		{
+			FILE* file = nullptr;
+			if ((fopen_s(&file, _path, "rb") != 0) || (file == nullptr))
+				return false;
+
+			std::string text;
+			char buffer[4096];
+			size_t read;
+			while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+				text.append(buffer, read);
+
+			fclose(file);
+
+			auto pos = FindValue(text, "graph", 0, text.size());
+			while (pos != std::string::npos)
+			{
+				auto next = FindValue(text, "graph", pos, text.size());
+				auto end = (next == std::string::npos) ? text.size() : next;
+				auto nameEnd = text.find('"', pos + 1);
+				auto median = FindValue(text, "median_ms", pos, end);
+				auto nodes = FindValue(text, "nodes", pos, end);
+				if ((text[pos] != '"') || (nameEnd == std::string::npos) || (median == std::string::npos) || (nodes == std::string::npos))
+					return false;
+
+				BaselineEntry entry;
+				entry.Name = text.substr(pos + 1, nameEnd - pos - 1);
+				entry.MedianMs = atof(text.c_str() + median);
+				entry.Nodes = strtoull(text.c_str() + nodes, nullptr, 10);
+				_entries.push_back(entry);
+
+				pos = next;
+			}
+
+			return !_entries.empty();
+		}
+
+		/*
+		*	Slower : median above the baseline by more than _threshold percent and _minimumMs (timer noise of quick
+		*	instances). Node count changes are reported too; they are deterministic and mean the search changed.
+		*/
+		static int Compare(const std::vector<DimacsResult>& _results, const std::vector<BaselineEntry>& _baseline, double _threshold, double _minimumMs)
+		{
+			int regressions = 0;
+
+			printf("%-16s %12s %12s %8s %14s %14s  %s\r\n", "Graph", "Base (ms)", "Now (ms)", "Change", "Base nodes", "Nodes", "Status");
+			for (auto& result : _results)
+			{
+				auto entry = std::find_if(_baseline.begin(), _baseline.end(), [&](const BaselineEntry& _entry) { return _entry.Name == result.Instance->Name; });
+				if (entry == _baseline.end())
+				{
+					printf("%-16s %12s %12.3f %8s %14s %14llu  new\r\n", result.Instance->Name, "-", result.MedianMs, "-", "-", result.Nodes);
+					continue;
+				}
+
+				double change = (entry->MedianMs > 0) ? (100 * (result.MedianMs - entry->MedianMs) / entry->MedianMs) : 0;
+				bool isSlower = (change > _threshold) && ((result.MedianMs - entry->MedianMs) > _minimumMs);
+				bool isFaster = (change < -_threshold) && ((entry->MedianMs - result.MedianMs) > _minimumMs);
+
+				const char* status = isSlower ? "REGRESSION" : (isFaster ? "faster" : "ok");
+				if (isSlower)
+					regressions++;
+
+				printf("%-16s %12.3f %12.3f %7.1f%% %14llu %14llu  %s%s\r\n", result.Instance->Name, entry->MedianMs, result.MedianMs, change,
+					entry->Nodes, result.Nodes, status, (entry->Nodes != result.Nodes) ? " (nodes changed)" : "");
+			}
+
+			return regressions;
+		}
+
+		int RunDimacs(int argc, char* argv[])
+		{
+			std::string directory = "graphs/Dimacs/clique";
+			const char *selection = "quick", *output = nullptr, *baseline = nullptr;
+			UInt32 repeat = 3;
+			double threshold = 10, minimumMs = 2;
+
+			for (int i = 0; i + 1 < argc; i += 2)
+			{
+				if (strcmp(argv[i], "-dir") == 0)
+					directory = argv[i + 1];
+				else if (strcmp(argv[i], "-graphs") == 0)
+					selection = argv[i + 1];
+				else if (strcmp(argv[i], "-repeat") == 0)
+					repeat = (UInt32)atoi(argv[i + 1]);
+				else if (strcmp(argv[i], "-out") == 0)
+					output = argv[i + 1];
+				else if (strcmp(argv[i], "-baseline") == 0)
+					baseline = argv[i + 1];
+				else if (strcmp(argv[i], "-threshold") == 0)
+					threshold = atof(argv[i + 1]);
+				else if (strcmp(argv[i], "-min-ms") == 0)
+					minimumMs = atof(argv[i + 1]);
+				else
+				{
+					printf("Unknown option %s\r\n", argv[i]);
+					return 1;
+				}
+			}
+
+			if ((argc & 1) != 0)
+			{
+				printf("Missing value of %s\r\n", argv[argc - 1]);
+				return 1;
+			}
+
+			if (repeat == 0)
+				repeat = 1;
+
+			std::vector<BaselineEntry> baselineEntries;
+			if ((baseline != nullptr) && !ReadBaseline(baseline, baselineEntries))
+			{
+				printf("Cannot read baseline %s\r\n", baseline);
+				return 1;
+			}
+
+			std::vector<DimacsResult> results;
+			int mismatches = 0;
+
+			printf("%-16s %8s %6s %6s %14s %12s %12s\r\n", "Graph", "Vertices", "Omega", "Found", "Nodes", "Min (ms)", "Median (ms)");
+			for (auto& instance : s_DimacsInstances)
+			{
+				if (!IsSelected(instance, selection))
+					continue;
+
+				DimacsResult result;
+				if (!RunInstance(instance, directory, repeat, result))
+				{
+					printf("%-16s cannot read %s/%s.clq.b\r\n", instance.Name, directory.c_str(), instance.Name);
+					mismatches++;
+					continue;
+				}
+
+				printf("%-16s %8u %6u %6u %14llu %12.3f %12.3f%s\r\n", instance.Name, (unsigned)result.Vertices, (unsigned)instance.Omega, (unsigned)result.Found,
+					result.Nodes, result.MinimumMs, result.MedianMs, (result.Found == instance.Omega) ? "" : "  WRONG");
+				fflush(stdout);
+
+				if (result.Found != instance.Omega)
+					mismatches++;
+
+				results.push_back(result);
+			}
+
+			if (output != nullptr)
+			{
+				FILE* file = nullptr;
+				if ((fopen_s(&file, output, "wb") != 0) || (file == nullptr))
+				{
+					printf("Cannot write %s\r\n", output);
+					return 1;
+				}
+
+				WriteJson(file, results, repeat);
+				fclose(file);
+			}
+
+			int regressions = 0;
+			if (!baselineEntries.empty())
+			{
+				printf("\r\n");
+				regressions = Compare(results, baselineEntries, threshold, minimumMs);
+				printf("%d regression(s) beyond %.1f%% against %s\r\n", regressions, threshold, baseline);
+			}
+
+			if (mismatches > 0)
+				printf("%d instance(s) failed\r\n", mismatches);
+
+			return (mismatches > 0) ? 2 : ((regressions > 0) ? 3 : 0);
+		}
+	}
+}
@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "Benchmark.h"
+#include "GraphUtility.h"
+#include "MemoryAllocation.h"
+#include "Parallel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Graph
+{
+	namespace Benchmark
+	{
+		enum struct Kernel : UInt32
+		{
+			PopCountAandB = 0,
+			PopCountAandBEarlyExit,
+			PopCountAandB_Set,
+			AandB,
+			AminusB,
+			GetMembers,
+			GetBitIndices,
+			FindNextBit,
+			SetNBits,
+			ExtractGraph,
+			ExtractGraphBitLoop,
+			ExtractBits,
+			ComplementGraph,
+			ExtractComplementGraph,
+
+			Count
+		};
+
+		struct KernelInfo
+		{
+			const char	*Name;
+			bool			IsGraph;		// one operation is a whole graph of _bits vertices, not a row of _bits.
+		};
+
+		// In the order of Kernel.
+		static const KernelInfo s_Kernels[] =
+		{
+			{ "PopCountAandB", false },
+			{ "PopCountAandB/exit", false },	// stops at a quarter of the expected count; bytes as for the full rows.
+			{ "PopCountAandB_Set", false },
+			{ "AandB", false },
+			{ "AminusB", false },
+			{ "GetMembers", false },
+			{ "GetBitIndices", false },
+			{ "FindNextBit", false },			// all non zero bytes of a row, one call each.
+			{ "SetNBits", false },
+			{ "ExtractGraph", true },			// mask of the density; pext path.
+			{ "ExtractGraph/bits", true },		// mask of one vertex in 64; bit by bit path.
+			{ "ExtractBits", false },
+			{ "ComplementGraph", true },
+			{ "ExtractComplementGraph", true },	// mask of the density; as ExtractGraph + ComplementGraph.
+		};
+
+		static_assert(sizeof(s_Kernels) / sizeof(s_Kernels[0]) == (size_t)Kernel::Count, "s_Kernels is out of sync with Kernel.");
+
+		// xorshift64*; each call gives four 16 bit lanes compared against the density.
+		struct Random
+		{
+			UInt64 State;
+
+			explicit Random(UInt64 _seed) : State((_seed == 0) ? 0x9E3779B97F4A7C15ULL : _seed) {}
+
+			UInt64 Next()
+			{
+				State ^= State >> 12;
+				State ^= State << 25;
+				State ^= State >> 27;
+				return State * 0x2545F4914F6CDD1DULL;
+			}
+
+			void Fill(UInt64* _p, size_t _bits, double _density)
+			{
+				UInt32 threshold = (UInt32)(_density * 65536);
+				memset(_p, 0, GetQWordAlignedSizeForBits(_bits));
+				for (size_t i = 0; i < _bits; i += 4)
+				{
+					auto value = Next();
+					for (size_t j = 0; (j < 4) && ((i + j) < _bits); j++, value >>= 16)
+						if ((value & 0xFFFF) < threshold)
+							_p[(i + j) >> 6] |= 1ULL << ((i + j) & 63);
+				}
+			}
+		};
+
+		/*
+		*	Inputs of a thread. Row kernels cycle through Rows rows of A, B and C (the working set); graph kernels read
+		*	Source, which all threads share, and write their own graphs.
+		*/
+		struct KernelData
+		{
+			size_t	Bits, Words, Rows;
+			UInt64	*A, *B, *C, *Ones, *Zeros;
+			ID			*List;
+			byte		*SizeOfBitset;
+			size_t	Minimum;
+
+			Ext::Array<Vertex>	Source, Complement, Extracted, Sparse;
+			byte						*Mask, *SparseMask;
+
+			KernelData()
+				: Bits(0), Words(0), Rows(0), A(nullptr), B(nullptr), C(nullptr), Ones(nullptr), Zeros(nullptr), List(nullptr), SizeOfBitset(nullptr),
+				Minimum(0), Mask(nullptr), SparseMask(nullptr)
+			{
+			}
+		};
+
+		struct KernelOptions
+		{
+			std::vector<size_t>	Sizes;
+			std::vector<double>	Densities;
+			bool						Kernels[(UInt32)Kernel::Count];
+			UInt32					Threads;
+			size_t					WorkingSet;		// bytes per thread.
+			size_t					MaximumGraph;	// vertices; a graph is Bits² / 8 bytes.
+			double					TargetMs;
+		};
+
+		static void Free(KernelData& _data)
+		{
+			for (auto p : { (void*)_data.A, (void*)_data.Ones, (void*)_data.List, (void*)_data.SizeOfBitset })
+				if (p != nullptr)
+					FreeMemory(p);
+
+			if (_data.Complement.size() > 0)
+				FreeGraph(_data.Complement);
+			if (_data.Extracted.size() > 0)
+				FreeGraph(_data.Extracted);
+			if (_data.Sparse.size() > 0)
+				FreeGraph(_data.Sparse);
+		}
+
+		static void Setup(KernelData& _data, const KernelOptions& _options, size_t _bits, double _density, UInt32 _thread, bool _isGraph)
+		{
+			Random random(_bits * 1000003 + (UInt64)(_density * 1000) * 7919 + _thread + 1);
+
+			_data.Bits = _bits;
+			_data.Words = GetQWordSizeForBits(_bits);
+
+			size_t rowBytes = _data.Words * sizeof(UInt64);
+			_data.Rows = _options.WorkingSet / (3 * rowBytes);
+			if (_data.Rows == 0)
+				_data.Rows = 1;
+
+			_data.A = (UInt64*)AllocMemory(3 * _data.Rows * rowBytes);
+			_data.B = _data.A + _data.Rows * _data.Words;
+			_data.C = _data.B + _data.Rows * _data.Words;
+			for (size_t r = 0; r < _data.Rows; r++)
+			{
+				random.Fill(_data.A + r * _data.Words, _bits, _density);
+				random.Fill(_data.B + r * _data.Words, _bits, _density);
+				random.Fill(_data.C + r * _data.Words, _bits, _density);
+			}
+
+			_data.Ones = (UInt64*)AllocMemory(2 * rowBytes);
+			_data.Zeros = _data.Ones + _data.Words;
+			memset(_data.Zeros, 0, rowBytes);
+			SetNBits(_data.Ones, _bits);
+
+			_data.List = (ID*)AllocMemory(sizeof(ID) * (_bits + 64));
+			_data.SizeOfBitset = (byte*)AllocMemory(sizeof(ID) * (_data.Words + 64) + GetSizeForBits(_bits));
+			_data.Minimum = (size_t)(_bits * _density * _density / 4);
+			if (_data.Minimum == 0)
+				_data.Minimum = 1;
+
+			if (_isGraph)
+			{
+				_data.Complement = CreateGraph(_bits);
+				_data.Extracted = CreateGraph(PopCount((UInt64*)_data.Mask, _data.Words));
+				_data.Sparse = CreateGraph(PopCount((UInt64*)_data.SparseMask, _data.Words));
+			}
+		}
+
+		static void SetupSource(KernelData& _data, size_t _bits, double _density)
+		{
+			Random random(_bits * 31 + (UInt64)(_density * 1000));
+			size_t words = GetQWordSizeForBits(_bits);
+
+			_data.Source = CreateGraph(_bits);
+			for (size_t i = 0; i < _bits; i++)
+			{
+				auto neighbours = (UInt64*)_data.Source[i].Neighbours;
+				random.Fill(neighbours, _bits, _density);
+				neighbours[i >> 6] &= ~(1ULL << (i & 63));
+				_data.Source[i].Count = (decltype(Vertex::Count))PopCount(neighbours, words);
+			}
+
+			_data.Mask = (byte*)AllocMemory(2 * words * sizeof(UInt64));
+			_data.SparseMask = _data.Mask + words * sizeof(UInt64);
+			random.Fill((UInt64*)_data.Mask, _bits, _density);
+			if (PopCount((UInt64*)_data.Mask, words) <= words)
+				SetNBits((UInt64*)_data.Mask, words + 1);
+
+			// ExtractGraph takes the bit by bit path up to one vertex per 64 bit word of the mask.
+			memset(_data.SparseMask, 0, words * sizeof(UInt64));
+			for (size_t i = 0; i < _bits; i += 64)
+				BitSet(_data.SparseMask, (decltype(Vertex::Id))(i + (random.Next() % ((_bits - i < 64) ? (_bits - i) : 64))));
+		}
+
+		static void FreeSource(KernelData& _data)
+		{
+			if (_data.Source.size() > 0)
+				FreeGraph(_data.Source);
+			if (_data.Mask != nullptr)
+				FreeMemory(_data.Mask);
+
+			_data.Mask = _data.SparseMask = nullptr;
+		}
+
+		// Bytes a operation reads and writes.
+		static double GetBytes(Kernel _kernel, const KernelData& _data, double _density)
+		{
+			double rowBytes = (double)_data.Words * sizeof(UInt64);
+			switch (_kernel)
+			{
+			case Kernel::PopCountAandB:
+			case Kernel::PopCountAandBEarlyExit:
+				return 2 * rowBytes;
+			case Kernel::PopCountAandB_Set:
+			case Kernel::AandB:
+			case Kernel::AminusB:
+				return 3 * rowBytes;
+			case Kernel::GetMembers:
+				return 3 * rowBytes + sizeof(ID) * _data.Bits * _density;
+			case Kernel::GetBitIndices:
+				return rowBytes + sizeof(ID) * _data.Bits * _density;
+			case Kernel::FindNextBit:
+			case Kernel::SetNBits:
+				return rowBytes;
+			case Kernel::ExtractGraph:
+			case Kernel::ExtractComplementGraph:
+				return (double)_data.Extracted.size() * (rowBytes + GetQWordAlignedSizeForBits(_data.Extracted.size()));
+			case Kernel::ExtractGraphBitLoop:
+				return (double)_data.Sparse.size() * (rowBytes + GetQWordAlignedSizeForBits(_data.Sparse.size()));
+			case Kernel::ExtractBits:
+				return 3 * rowBytes;
+			case Kernel::ComplementGraph:
+				return 2 * _data.Bits * rowBytes;
+			default:
+				return 0;
+			}
+		}
+
+		// Runs _operations of _kernel; the result only keeps the work from being optimized away.
+		static UInt64 RunKernel(Kernel _kernel, KernelData& _data, UInt64 _operations)
+		{
+			UInt64 sink = 0;
+			size_t words = _data.Words, rows = _data.Rows, r = 0;
+
+#define ForEachRow(body)	for (UInt64 n = 0; n < _operations; n++, r = ((r + 1) == rows) ? 0 : (r + 1)) { auto a = _data.A + r * words; auto b = _data.B + r * words; body; }
+			switch (_kernel)
+			{
+			case Kernel::PopCountAandB:
+				ForEachRow(sink += PopCountAandB(a, b, words));
+				break;
+			case Kernel::PopCountAandBEarlyExit:
+				ForEachRow(sink += PopCountAandB(a, b, words, _data.Minimum));
+				break;
+			case Kernel::PopCountAandB_Set:
+				ForEachRow(auto c = _data.C + r * words; sink += PopCountAandB_Set(c, a, words); (void)b);
+				break;
+			case Kernel::AandB:
+				ForEachRow(auto c = _data.C + r * words; AandB(a, b, c, words); sink += c[0]);
+				break;
+			case Kernel::AminusB:
+				ForEachRow(auto c = _data.C + r * words; AminusB(a, b, c, words); sink += c[0]);
+				break;
+			case Kernel::GetMembers:
+				ForEachRow(sink += GetMembers(a, _data.Ones, _data.Zeros, _data.List, words); (void)b);
+				break;
+			case Kernel::GetBitIndices:
+				ForEachRow(sink += GetBitIndices(a, _data.List, words); (void)b);
+				break;
+			case Kernel::FindNextBit:
+				ForEachRow(
+					byte* p = (byte*)a;
+					size_t bytes = GetSizeForBits(_data.Bits);
+					for (size_t k = 0; k < bytes; k++)
+					{
+						k += FindNextBit(p + k, bytes - k) >> 3;
+						sink += k;
+					}
+					(void)b);
+				break;
+			case Kernel::SetNBits:
+				ForEachRow(auto c = _data.C + r * words; SetNBits(c, _data.Bits); sink += c[0]; (void)a; (void)b);
+				break;
+			case Kernel::ExtractBits:
+				ForEachRow(auto c = _data.C + r * words; sink += ExtractBits((byte*)a, (byte*)c, (byte*)b, _data.SizeOfBitset, _data.Bits));
+				break;
+			case Kernel::ExtractGraph:
+				for (UInt64 n = 0; n < _operations; n++)
+					sink += ExtractGraph(_data.Source, _data.Extracted, _data.Mask, _data.SizeOfBitset) ? _data.Extracted[0].Count : 0;
+				break;
+			case Kernel::ExtractGraphBitLoop:
+				for (UInt64 n = 0; n < _operations; n++)
+					sink += ExtractGraph(_data.Source, _data.Sparse, _data.SparseMask, _data.SizeOfBitset) ? _data.Sparse[0].Count : 0;
+				break;
+			case Kernel::ComplementGraph:
+				for (UInt64 n = 0; n < _operations; n++)
+				{
+					ComplementGraph(_data.Source, _data.Complement);
+					sink += _data.Complement[0].Count;
+				}
+				break;
+			case Kernel::ExtractComplementGraph:
+				for (UInt64 n = 0; n < _operations; n++)
+					sink += ExtractComplementGraph(_data.Source, _data.Extracted, _data.Mask, _data.SizeOfBitset) ? _data.Extracted[0].Count : 0;
+				break;
+			default:
+				break;
+			}
+#undef ForEachRow
+
+			return sink;
+		}
+
+		// Runs _body(thread) on _threads threads released together; returns the wall time in ns.
+		template <class Body>
+		static double RunThreads(UInt32 _threads, Body _body)
+		{
+			std::atomic<UInt32> ready(0);
+			std::atomic<bool> go(false);
+			std::vector<std::thread> threads;
+
+			for (UInt32 t = 1; t < _threads; t++)
+				threads.emplace_back([&, t]()
+				{
+					ready++;
+					while (!go)
+						std::this_thread::yield();
+					_body(t);
+				});
+
+			while (ready != (_threads - 1))
+				std::this_thread::yield();
+
+			auto start = std::chrono::steady_clock::now();
+			go = true;
+			_body(0);
+
+			for (auto& thread : threads)
+				thread.join();
+
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		static std::atomic<UInt64> s_Sink(0);
+
+		// Operations for about _targetMs on one thread.
+		static UInt64 Calibrate(Kernel _kernel, KernelData& _data, double _targetMs)
+		{
+			UInt64 operations = 1;
+			for (;;)
+			{
+				auto start = std::chrono::steady_clock::now();
+				s_Sink += RunKernel(_kernel, _data, operations);
+				double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+				if ((ms >= (_targetMs / 8)) || (operations >= (1ULL << 40)))
+					return (UInt64)(operations * _targetMs / ((ms > 0) ? ms : 1e-3)) + 1;
+
+				operations *= 2;
+			}
+		}
+
+		static bool ParseList(const char* _text, std::vector<double>& _values)
+		{
+			_values.clear();
+			for (const char* p = _text; *p != 0;)
+			{
+				char* end = nullptr;
+				double value = strtod(p, &end);
+				if ((end == p) || (value <= 0))
+					return false;
+
+				_values.push_back(value);
+				p = (*end == ',') ? (end + 1) : end;
+				if ((*end != ',') && (*end != 0))
+					return false;
+			}
+
+			return !_values.empty();
+		}
+
+		int RunKernels(int argc, char* argv[])
+		{
+			KernelOptions options;
+			std::vector<double> values;
+
+			options.Sizes = { 64, 256, 1024, 4096, 16384, 65536 };
+			options.Densities = { 0.1, 0.25, 0.5, 0.75, 0.9, 0.99 };
+			for (auto& isEnabled : options.Kernels)
+				isEnabled = true;
+			options.Threads = 0;
+			options.WorkingSet = 16 << 20;
+			options.MaximumGraph = 16384;
+			options.TargetMs = 20;
+
+			for (int i = 0; i + 1 < argc; i += 2)
+			{
+				if (strcmp(argv[i], "-kernels") == 0)
+				{
+					for (auto& isEnabled : options.Kernels)
+						isEnabled = false;
+
+					std::string list = std::string(argv[i + 1]) + ",";
+					for (size_t start = 0, end; (end = list.find(',', start)) != std::string::npos; start = end + 1)
+					{
+						auto name = list.substr(start, end - start);
+						UInt32 k;
+						for (k = 0; k < (UInt32)Kernel::Count; k++)
+							if (name == s_Kernels[k].Name)
+								break;
+
+						if (k == (UInt32)Kernel::Count)
+						{
+							printf("Unknown kernel %s\r\n", name.c_str());
+							return 1;
+						}
+
+						options.Kernels[k] = true;
+					}
+				}
+				else if ((strcmp(argv[i], "-sizes") == 0) && ParseList(argv[i + 1], values))
+				{
+					options.Sizes.clear();
+					for (auto value : values)
+						options.Sizes.push_back((size_t)value);
+				}
+				else if ((strcmp(argv[i], "-densities") == 0) && ParseList(argv[i + 1], values))
+					options.Densities = values;
+				else if (strcmp(argv[i], "-threads") == 0)
+					options.Threads = (UInt32)atoi(argv[i + 1]);
+				else if (strcmp(argv[i], "-ws") == 0)
+					options.WorkingSet = (size_t)atoi(argv[i + 1]) << 10;
+				else if (strcmp(argv[i], "-max-graph") == 0)
+					options.MaximumGraph = (size_t)atoi(argv[i + 1]);
+				else if (strcmp(argv[i], "-ms") == 0)
+					options.TargetMs = atof(argv[i + 1]);
+				else
+				{
+					printf("Invalid option %s %s\r\n", argv[i], argv[i + 1]);
+					return 1;
+				}
+			}
+
+			if ((argc & 1) != 0)
+			{
+				printf("Missing value of %s\r\n", argv[argc - 1]);
+				return 1;
+			}
+
+			UInt32 threads = Parallel::GetThreadCount(options.Threads);
+			std::vector<KernelData> data(threads);
+
+			printf("Working set %llu KB per thread, %.0f ms per measurement, %u thread(s)\r\n", (UInt64)(options.WorkingSet >> 10), options.TargetMs, threads);
+			printf("%-20s %8s %8s %12s %10s", "Kernel", "Bits", "Density", "1T ns/op", "1T GB/s");
+			if (threads > 1)
+				printf(" %12s %10s %8s", "NT ns/op", "NT GB/s", "Scaling");
+			printf("\r\n");
+
+			for (auto bits : options.Sizes)
+			{
+				for (auto density : options.Densities)
+				{
+					bool isGraph = false;
+					for (UInt32 k = 0; k < (UInt32)Kernel::Count; k++)
+						isGraph |= options.Kernels[k] && s_Kernels[k].IsGraph && (bits <= options.MaximumGraph);
+
+					if (isGraph)
+						SetupSource(data[0], bits, density);
+
+					for (UInt32 t = 1; t < threads; t++)
+					{
+						data[t].Source = data[0].Source;
+						data[t].Mask = data[0].Mask;
+						data[t].SparseMask = data[0].SparseMask;
+					}
+
+					// Each thread first touches its own data.
+					RunThreads(threads, [&](UInt32 _thread) { Setup(data[_thread], options, bits, density, _thread, isGraph); });
+
+					for (UInt32 k = 0; k < (UInt32)Kernel::Count; k++)
+					{
+						if (!options.Kernels[k] || (s_Kernels[k].IsGraph && !isGraph))
+							continue;
+
+						auto kernel = (Kernel)k;
+						auto bytes = GetBytes(kernel, data[0], density);
+						auto operations = Calibrate(kernel, data[0], options.TargetMs);
+
+						double ns = RunThreads(1, [&](UInt32) { s_Sink += RunKernel(kernel, data[0], operations); }) / operations;
+						printf("%-20s %8llu %8.2f %12.2f %10.2f", s_Kernels[k].Name, (UInt64)bits, density, ns, bytes / ns);
+
+						if (threads > 1)
+						{
+							double nsAll = RunThreads(threads, [&](UInt32 _thread) { s_Sink += RunKernel(kernel, data[_thread], operations); }) / (operations * threads);
+							printf(" %12.2f %10.2f %7.2fx", nsAll, bytes / nsAll, ns / nsAll);
+						}
+
+						printf("\r\n");
+						fflush(stdout);
+					}
+
+					for (auto& threadData : data)
+						Free(threadData);
+
+					if (isGraph)
+						FreeSource(data[0]);
+
+					for (auto& threadData : data)
+						threadData = KernelData();
+				}
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "Benchmark.h"
+#include "PrivateTypes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+namespace Graph
+{
+	namespace Benchmark
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		static double GetNanoseconds(Clock::time_point _start, UInt64 _operations)
+		{
+			return std::chrono::duration<double, std::nano>(Clock::now() - _start).count() / ((_operations == 0) ? 1 : _operations);
+		}
+
+		/*
+		*	TryFindClique frame pattern : each level allocates a graph and a bit set and frees both on return.
+		*	Blocks hold only a few frames, so a deep search spans many blocks.
+		*/
+		static double BenchmarkFrames(UInt32 _blocks, UInt32 _iterations)
+		{
+			const UInt32 graphSize = 4096, bitSetSize = 64, framesPerBlock = 4;
+			StackMemoryPool pool((graphSize + bitSetSize + 64) * framesPerBlock);
+			std::vector<void*> frames(_blocks * framesPerBlock * 2);
+			UInt64 operations = 0;
+
+			auto start = Clock::now();
+			for (UInt32 n = 0; n < _iterations; n++)
+			{
+				size_t depth = frames.size() / 2;
+				for (size_t i = 0; i < depth; i++)
+				{
+					frames[2 * i] = pool.Allocate(graphSize);
+					frames[2 * i + 1] = pool.Allocate(bitSetSize);
+				}
+
+				for (size_t i = depth; i-- > 0;)
+				{
+					pool.Free(frames[2 * i + 1]);
+					pool.Free(frames[2 * i]);
+				}
+
+				operations += depth * 2;
+			}
+
+			return GetNanoseconds(start, operations);
+		}
+
+		/*
+		*	Fragmented pool : one long lived allocation pins every block, while the search churns
+		*	allocations whose frees land in the lower blocks (graph memory reclaimed out of order).
+		*/
+		static double BenchmarkFragmented(UInt32 _blocks, UInt32 _iterations)
+		{
+			const UInt32 size = 1024, perBlock = 8;
+			StackMemoryPool pool(size * perBlock + 256);
+			std::vector<void*> pinned, churn(_blocks * (perBlock - 1));
+			UInt64 operations = 0;
+
+			for (UInt32 i = 0; i < _blocks; i++)
+			{
+				pinned.push_back(pool.Allocate(size));
+				for (UInt32 j = 1; j < perBlock; j++)
+					churn[i * (perBlock - 1) + j - 1] = pool.Allocate(size);
+			}
+
+			auto start = Clock::now();
+			for (UInt32 n = 0; n < _iterations; n++)
+			{
+				// oldest first
+				for (size_t i = 0; i < churn.size(); i++)
+					pool.Free(churn[i]);
+
+				for (size_t i = 0; i < churn.size(); i++)
+					churn[i] = pool.Allocate(size);
+
+				operations += churn.size() * 2;
+			}
+
+			double ns = GetNanoseconds(start, operations);
+
+			for (size_t i = churn.size(); i-- > 0;)
+				pool.Free(churn[i]);
+
+			for (size_t i = pinned.size(); i-- > 0;)
+				pool.Free(pinned[i]);
+
+			return ns;
+		}
+
+		int RunPool(int argc, char* argv[])
+		{
+			UInt32 iterations = (argc > 0) ? (UInt32)atoi(argv[0]) : 0;
+			if (iterations == 0)
+				iterations = 2000;
+
+			printf("%10s %20s %20s\r\n", "Blocks", "Frames (ns/op)", "Fragmented (ns/op)");
+			for (UInt32 blocks = 1; blocks <= 256; blocks *= 4)
+			{
+				auto frames = BenchmarkFrames(blocks, iterations);
+				auto fragmented = BenchmarkFragmented(blocks, (iterations / blocks > 0) ? iterations / blocks : 1);
+				printf("%10d %20.2f %20.2f\r\n", (int)blocks, frames, fragmented);
+			}
+
+			return 0;
+		}
+	}
+}
@@ -16,7 +16,7 @@
 #if (!BIT_H)
 #define BIT_H
 
-#include <intrin.h>
+#include "Platform.h"
 #include "Types.h"
 
 #define	BitSetMaxValue	0xFF
@@ -15,8 +15,14 @@
 #include "Templates.h"
 #include "PrivateTypes.h"
 #include "MemoryAllocation.h"
+#include "Counters.h"
+#include "Profile.h"
 
 #include <stdio.h>
+#include <math.h>
+
+#include <algorithm>
+#include <new>
 
 
 namespace Graph
@@ -216,32 +222,98 @@ namespace Graph
 
 			Int64	callCount, startCallCount;
 			Ext::BooleanError isCliqueExist;
+
+			ArenaMark	scratchMark;				// before activeVertexList
+			ArenaMark	pushScratchMark, pushGraphMark;	// before the subgraph of the nested call
 		};
 
 		const int FramesPerBlock = 5;
 
+		static size_t s_MemoryBudget = 0;
+		static bool s_CounterDepthBreakdown = false;
+		static UInt32 s_ProfileSamplingInterval = 0;	// 0 : profiling off.
+		static VertexOrder s_VertexOrder = VertexOrder::None;
+
 		class ResourceManager
 		{
 		public:
+			MemoryBudget			Budget;				// shared by the pools and call frames; declared first for initialization.
 			StackMemoryPool		GraphMemoryPool;
 			StackMemoryPool		MemoryPool;
+			StackArena				ScratchArena;		// per call frame scratch of TryFindClique.
+			StackArena				GraphArena;			// subgraphs of TryFindClique; without a budget only (no eviction).
 			Int32						*Stack;
 			byte						*BitSet, *BitSet2;
 			decltype(Vertex::Id)	*lId, *lId2, *lId3;
 			TryFindCliqueThisContext This;
 			TryFindCliqueCallFrame	*CallFrame;
 
-			UInt64	Calls, PartitionExtr, TwoNHits, TwoNColorHits, SubgraphHits, BtmUpHits, BtmUpHits2, BtmUpCheck, BtmUpCheck2, Count9, Count11, Count12, Count13, Count14;
+			CounterSet				Counters;
+			SearchProfile			*Profile;			// nullptr unless SetProfiling(true) (and CliqueProfile).
+
+			// FindClique progress; see SetProgressHandler().
+			OnProgress				ProgressHandler;
+			void						*ProgressContext;
+			UInt32					ProgressInterval;
+			bool						IsProgressActive;
+			std::chrono::steady_clock::time_point	ProgressStart, ProgressLast;
+			struct
+			{
+				UInt64	Count, StartCalls;			// depth 0 steps begun, nodes when the current one began.
+				double	Sx, Sy, Sxx, Sxy;			// least squares sums of (step, ln cost) of the finished steps.
+			} Steps;
+
+			// FindClique ends every subproblem once past Deadline, keeping the largest clique found; see GetChromaticNumber().
+			bool						HasDeadline, IsTimedOut;
+			std::chrono::steady_clock::time_point	Deadline;
+
+			decltype(Vertex::Id)	Capacity;
+			decltype(Vertex::Id)	*CliqueMembersBuffer;
+			bool	TraceStatistics;
+			VertexOrder	Order;					// of the top level graph of FindClique; see SetVertexOrder().
 
 		public:
+			/*
+			*	_blockSize:
+			*			ResourceManager.m_Stack		:		2 * 32 * sizeof(int);
+			*			ResourceManager.m_BitSet,2	:		3 * GetQWordAlignedSizeForBits(_graphDegree);
+			*
+			*		[
+			*			Ext::Array<Vertex>			:		6 * GetQWORDAlignedSize(_graphDegree * sizeof(ID));
+			*												:		4 * GetQWordAlignedSizeForBits(_graphDegree);
+			*		] * FramesPerBlock * 2
+			*/
+			static UInt32 GetBlockSize(decltype(Vertex::Id) _graphDegree)
+			{
+				UInt32	bitSetLength = (UInt32)GetQWordAlignedSizeForBits(_graphDegree);
+				return (UInt32)(2 * 32 * sizeof(int) + bitSetLength * 3 + (3 * GetQWordAlignedSize(_graphDegree * sizeof(ID)) + 3 * bitSetLength) * FramesPerBlock * 2);
+			}
+
+			ResourceManager(decltype(Vertex::Id) _graphDegree)
+				: ResourceManager(_graphDegree, GetBlockSize(_graphDegree))
+			{
+			}
+
 			ResourceManager(decltype(Vertex::Id) _graphDegree, UInt32 _blockSize)
-				: MemoryPool(_blockSize), Stack(nullptr), GraphMemoryPool((UInt32)(GetGraphAllocationSize(_graphDegree) * FramesPerBlock))
+				: Budget(s_MemoryBudget), MemoryPool(_blockSize, UINT_MAX, &Budget), Stack(nullptr), GraphMemoryPool((UInt32)(GetGraphAllocationSize(_graphDegree) * ((s_MemoryBudget == 0) ? FramesPerBlock : 1)), UINT_MAX, &Budget),
+				  ScratchArena(_blockSize, &Budget), GraphArena(GetGraphAllocationSize(_graphDegree) * FramesPerBlock, &Budget),
+				  Counters(_graphDegree / 2 + 2, s_CounterDepthBreakdown), Profile(nullptr),
+				  ProgressHandler(nullptr), ProgressContext(nullptr), ProgressInterval(0), IsProgressActive(false), HasDeadline(false), IsTimedOut(false), Capacity(_graphDegree), TraceStatistics(false), Order(s_VertexOrder)
 			{
 				size_t allocationSize = sizeof(TryFindCliqueCallFrame) * (_graphDegree / 2 + 2);
+				if (!Budget.Reserve(allocationSize))
+					throw "memory budget exceeded.";
+
 				CallFrame = (TryFindCliqueCallFrame*)AllocMemory(allocationSize);
-				memset(CallFrame, 0, allocationSize);
+				for (size_t i = 0, count = _graphDegree / 2 + 2; i < count; i++)
+					new (CallFrame + i) TryFindCliqueCallFrame();
 
 				void	*ptr = MemoryPool.Allocate((2 * 32 * sizeof(Int32)) + GetQWordAlignedSizeForBits(_graphDegree) * 2 + GetQWordAlignedSize(_graphDegree * sizeof(ID)) * 4);
+				if (ptr == nullptr)
+				{
+					FreeMemory(CallFrame);
+					throw "memory budget exceeded.";
+				}
 
 				// allocate Bitset2 at the top since we may not be using most of the cases.
 				BitSet2 = (byte*)ptr;
@@ -251,168 +323,434 @@ namespace Graph
 				lId2 = decltype(this->lId2) (((byte*)lId) + GetQWordAlignedSize(_graphDegree * sizeof(ID)));
 				lId3 = decltype(this->lId3) (((byte*)lId2) + GetQWordAlignedSize(_graphDegree * sizeof(ID)));
 
-				This.ctor(decltype(TryFindCliqueThisContext::CliqueMembers) (((byte*)lId3) + GetQWordAlignedSize(_graphDegree * sizeof(ID))), 0, 0, false);
-				ClearCounters();
+				CliqueMembersBuffer = decltype(this->CliqueMembersBuffer) (((byte*)lId3) + GetQWordAlignedSize(_graphDegree * sizeof(ID)));
+				This.ctor(CliqueMembersBuffer, 0, 0, false);
+				Counters.Clear();
+
+				if ((s_ProfileSamplingInterval > 0) && CliqueProfile)
+					Profile = new SearchProfile(_graphDegree / 2 + 2, s_ProfileSamplingInterval);
 			}
 
 			~ResourceManager()
 			{
+				if (Profile != nullptr)
+					delete Profile;
+
 				FreeMemory(CallFrame);
+				Budget.Release(sizeof(TryFindCliqueCallFrame) * (Capacity / 2 + 2));
 				CallFrame = nullptr;
 
 				MemoryPool.Free(BitSet2);
 			}
 
-			void ClearCounters()
+			// Prepares the instance for the next top level invocation.
+			void Reset()
 			{
-				Calls = PartitionExtr = TwoNHits = TwoNColorHits = SubgraphHits = BtmUpHits = BtmUpHits2 = BtmUpCheck = BtmUpCheck2 = Count9 = Count11 = Count12 = Count13 = Count14 = 0;
+				for (size_t i = 0, count = Capacity / 2 + 2; i < count; i++)
+					CallFrame[i] = TryFindCliqueCallFrame();
+				This.ctor(CliqueMembersBuffer, 0, 0, false);
+				Counters.Clear();
+				if (Profile != nullptr)
+					Profile->Clear();
+
+				IsProgressActive = false;
+				IsTimedOut = false;
 			}
 
-			void* AllocateGraphMemory(size_t size)
+			/*
+			*	Graph memory for a subgraph created at _depth. Graphs of the ancestors of _depth (oldest first) are
+			*	released to make room; they are recreated from the reference graph on return.
+			*	Near the memory budget an ancestor is released before allocating, so scratch memory is left room.
+			*	nullptr : the budget is reached and no ancestor graph is left to release.
+			*/
+			void* AllocateGraphMemory(size_t size, decltype(Vertex::Id) _depth)
 			{
-				auto ptr = GraphMemoryPool.Allocate(GetGraphAllocationSize(size));
-				if (ptr == nullptr)
+				if (Budget.Limit == 0)
+					return GraphArena.Allocate(GetGraphAllocationSize(size));
+
+				void* ptr = Budget.IsNearLimit() ? nullptr : GraphMemoryPool.Allocate(GetGraphAllocationSize(size));
+
+				while ((ptr == nullptr) && (This.TopGraphForMemoryReclaim < _depth))
 				{
 					auto i = This.TopGraphForMemoryReclaim++;
-					GraphMemoryPool.Free(CallFrame[i]._graph.ptr());
-					CallFrame[i]._graph = Ext::Array<Graph::Vertex>(nullptr, CallFrame[i]._graph.size());
+					if (CallFrame[i]._graph.ptr() != nullptr)
+					{
+						GraphMemoryPool.Free(CallFrame[i]._graph.ptr());
+						CallFrame[i]._graph = Ext::Array<Graph::Vertex>(nullptr, CallFrame[i]._graph.size());
+						CountEvent(Counters, GraphEvictions);
+					}
+
+					ptr = GraphMemoryPool.Allocate(GetGraphAllocationSize(size));
+				}
+
+				if (ptr == nullptr)
+					ptr = GraphMemoryPool.Allocate(GetGraphAllocationSize(size));
+
+				if ((ptr == nullptr) && (Budget.Limit != 0))
+				{
+					// Blocks kept for reuse hold budget too.
+					MemoryPool.Trim();
+					GraphMemoryPool.Trim();
 					ptr = GraphMemoryPool.Allocate(GetGraphAllocationSize(size));
 				}
 
 				return ptr;
 			}
-		};
-	}
 
-	namespace SAT
-	{
-		struct VariableStatistics
-		{
-			ID ClauseLiterals;
-			ID Clauses;
-			ID TrivialClauses;
-		};
+			// _mark : GraphArena.Mark() taken before the allocation of _ptr.
+			void ReleaseGraphMemory(void* _ptr, const ArenaMark& _mark)
+			{
+				if (Budget.Limit == 0)
+					GraphArena.Release(_mark);
+				else
+					GraphMemoryPool.Free(_ptr);
+			}
 
-		struct Variable
-		{
-			VariableStatistics Positive;
-			VariableStatistics Negative;
+			void StartProgress()
+			{
+				IsProgressActive = (ProgressHandler != nullptr);
+				ProgressStart = ProgressLast = std::chrono::steady_clock::now();
+				memset(&Steps, 0, sizeof(Steps));
+			}
 
-			bool IsPure()
+			void StopProgress()
 			{
-				return ((Positive.Clauses == 0) || (Negative.Clauses == 0));
-			};
+				if (IsProgressActive)
+					ReportProgress(0, true);
+
+				IsProgressActive = false;
+			}
 
-			bool IsPotentialClauseCombiner()
+			// Called on every TryFindClique enter; the clock is read once in 256 calls. Not within nested GetClusters.
+			forceinline void CheckProgress(decltype(Vertex::Id) _depth)
 			{
-				return ((Positive.Clauses == 1) && (Negative.Clauses == 1));
+				if (!IsProgressActive || (This.ZeroReferenceDepth != 0))
+					return;
+
+				if (_depth == 1)
+					AddProgressStep();
+
+				if ((Counters.Get(Counter::Calls) & 0xFF) == 0)
+					ReportProgress(_depth, false);
 			}
 
-			ID TotalClauses()
+			// Called on every TryFindClique enter; the clock is read once in 256 calls.
+			forceinline bool IsPastDeadline()
 			{
-				return Positive.Clauses + Negative.Clauses;
-			};
-		};
+				if (HasDeadline && !IsTimedOut && ((Counters.Get(Counter::Calls) & 0xFF) == 0))
+					IsTimedOut = (std::chrono::steady_clock::now() >= Deadline);
 
-		enum struct ReturnCallSite : byte
-		{
-			Invalid = 0,
-			Exit = 1,
-			Reduction = 2,
-		};
+				return IsTimedOut;
+			}
 
-		struct SolveCallReturnParam
-		{
-			ID Assignment;
-			ID Variable;
-			bool IsSuccess;
+			/*
+			*	A depth 0 step runs from one depth 1 enter to the next. ln(cost) of the finished steps is fitted
+			*	against the step index by least squares : cost(step) ~ exp(Intercept + Slope * step).
+			*/
+			void AddProgressStep()
+			{
+				auto calls = Counters.Get(Counter::Calls) - 1;
+				if (Steps.Count++ > 0)
+				{
+					double x = (double)(Steps.Count - 2), y = log((double)(calls - Steps.StartCalls) + 1);
+					Steps.Sx += x;
+					Steps.Sy += y;
+					Steps.Sxx += x * x;
+					Steps.Sxy += x * y;
+				}
+
+				Steps.StartCalls = calls;
+			}
 
-			void ctor(ID variable, ID assignment, bool isSuccess)
+			// Sum of _ratio^1 .. _ratio^_count.
+			static double GeometricSum(double _ratio, double _count)
 			{
-				Variable = variable;
-				Assignment = assignment;
-				IsSuccess = isSuccess;
+				return (fabs(_ratio - 1) < 1e-9) ? _count : (_ratio * (1 - pow(_ratio, _count)) / (1 - _ratio));
 			}
-		};
 
-		struct SolveCallFrame
-		{
-			Formula _formula;
-			Ext::List<VariableAssignmentOverride, ID> _assignmentOverride;
-			decltype(Vertex::Id) _assignmentOrder;
+			/*
+			*	Frames above _depth hold the state saved when they pushed; depth 0 is the top level.
+			*		done0, remaining0	:	vertices removed from depth 0 so far / still to process before the bound stops it.
+			*		f1						:	same fraction of the depth 1 frame, i.e. of the current depth 0 step.
+			*	Weighted by observed cost : the remaining steps (remaining0 at the steps per vertex seen so far) are
+			*	costed by the fit of AddProgressStep(), the current one by its nodes so far / f1. The fraction is
+			*	nodes so far versus nodes so far and remaining.
+			*/
+			void ReportProgress(decltype(Vertex::Id) _depth, bool _isFinal)
+			{
+				auto now = std::chrono::steady_clock::now();
+				if (!_isFinal && (std::chrono::duration_cast<std::chrono::milliseconds>(now - ProgressLast).count() < ProgressInterval))
+					return;
 
-			ID assignmentOrder;
-			int assignProbeVariableId;
+				ProgressLast = now;
 
-			ReturnCallSite ReturnTo;
+				Progress progress;
+				double nodes = (double)Counters.Get(Counter::Calls);
 
-			UInt64	Calls;
-		};
+				progress.ElapsedSeconds = std::chrono::duration<double>(now - ProgressStart).count();
+				progress.Nodes = Counters.Get(Counter::Calls);
+				progress.NodesPerSecond = (progress.ElapsedSeconds > 0) ? (nodes / progress.ElapsedSeconds) : 0;
+				progress.Incumbent = This.CliqueSize;
+				progress.Depth = _depth;
+				progress.Fraction = _isFinal ? 1 : 0;
+				progress.EtaSeconds = _isFinal ? 0 : -1;
 
-		struct SolveThisContext
-		{
-			Formula _formula;
-			SAT::VariableAssignment *_variableAssignment;
-			SAT::Variable *_variables;
+				if (!_isFinal && (_depth >= 1))
+				{
+					auto& frame0 = CallFrame[0];
+					auto& frame1 = CallFrame[1];
+					double done0 = (double)(frame0._graph.size() - frame0.activeVertexCount);
+					double remaining0 = (frame0.activeVertexCount >= frame0.cliqueSize) ? (double)(frame0.activeVertexCount - frame0.cliqueSize + 1) : 1;
+					double f1 = 0;
 
-			ID *OriginalVertexId;
-			void *CliqueMembers;
-			void *GraphMemory;
-			ID TempGraphSize;
+					if ((_depth >= 2) && (frame1._graph.size() > 0))
+					{
+						double done1 = (double)(frame1._graph.size() - frame1.activeVertexCount);
+						double remaining1 = (frame1.activeVertexCount >= frame1.cliqueSize) ? (double)(frame1.activeVertexCount - frame1.cliqueSize + 1) : 1;
+						f1 = done1 / (done1 + remaining1);
+					}
 
-			ID AssignedDepth;
-			bool	TraceEvaluation;
+					double finished = (double)(Steps.Count - 1), currentNodes = nodes - (double)Steps.StartCalls;
+					if ((finished >= 2) && (done0 > 0))
+					{
+						double d = finished * Steps.Sxx - Steps.Sx * Steps.Sx;
+						double slope = (d > 0) ? ((finished * Steps.Sxy - Steps.Sx * Steps.Sy) / d) : 0;
+						slope = (slope < -1) ? -1 : ((slope > 0.1) ? 0.1 : slope);
+
+						double intercept = (Steps.Sy - slope * Steps.Sx) / finished;
+						double predicted = exp(intercept + slope * finished);
+						double currentCost = (f1 > 0) ? (currentNodes / f1) : predicted;
+						if (currentCost < currentNodes)
+							currentCost = currentNodes;
+
+						double stepsLeft = remaining0 * (finished + 1) / done0;
+						double remainingCost = (currentCost - currentNodes) + predicted * GeometricSum(exp(slope), (stepsLeft > 1) ? (stepsLeft - 1) : 0);
+						progress.Fraction = nodes / (nodes + remainingCost);
+					}
+					else
+						progress.Fraction = (done0 + f1) / (done0 + remaining0);
 
-			SolveThisContext()
-				: _variableAssignment(nullptr),
-				_variables(nullptr),
-				OriginalVertexId(nullptr), CliqueMembers(nullptr),
-				GraphMemory(nullptr), TempGraphSize(0),
-				AssignedDepth(0), TraceEvaluation(false)
-			{
-			}
+					progress.Fraction = (progress.Fraction < 0) ? 0 : ((progress.Fraction > 1) ? 1 : progress.Fraction);
+					if (progress.Fraction >= 0.001)		// below, the estimate is dominated by the first steps.
+						progress.EtaSeconds = progress.ElapsedSeconds * (1 - progress.Fraction) / progress.Fraction;
+				}
 
-			void ctor(Formula _formula, SAT::VariableAssignment *_variableAssignment,
-				SAT::Variable *_variables, ID *originalVertexId, void *cliqueMembers,
-				void *pGraphMemory, ID tempGraphSize, bool traceEvaluation)
-			{
-				this->_formula = _formula;
-				this->_variableAssignment = _variableAssignment;
-				this->_variables = _variables;
-				this->OriginalVertexId = originalVertexId;
-				this->CliqueMembers = cliqueMembers;
-				this->GraphMemory = pGraphMemory;
-				this->TempGraphSize = tempGraphSize;
-				this->TraceEvaluation = traceEvaluation;
-				this->AssignedDepth = 0;
+				ProgressHandler(progress, ProgressContext);
 			}
 		};
+	}
+
+	namespace SAT
+	{
+		//
+		//	Literal v is indexed 2v and literal -v 2v + 1, for the occurrence counts and the watch lists.
+		//
+
+		forceinline ID GetLiteralIndex(int _literal)
+		{
+			return (_literal < 0) ? (((ID)-_literal << 1) | 1) : ((ID)_literal << 1);
+		}
+
+		forceinline TruthValue GetLiteralValue(const VariableAssignment *_assignment, int _literal)
+		{
+			auto value = _assignment[(_literal < 0) ? -_literal : _literal].Value;
+			if (value == TruthValue::Unassigned)
+				return TruthValue::Unassigned;
+
+			return ((_literal < 0) == (value == TruthValue::False)) ? TruthValue::True : TruthValue::False;
+		}
+
+		//
+		//	State of the search, allocated once per formula.
+		//		Clauses : persistent copy of the formula without duplicate literals and tautologies. The first two
+		//			literals of a clause are its watches; a clause is in the watch list of both, and moves to another
+		//			literal of its own when a watch becomes false. The capacity of a watch list is therefore the
+		//			occurrence count of its literal, and the lists are never reallocated.
+		//		Trail : assigned literals in assignment order. VariableAssignment::Order is the trail position and
+		//			Decisions the trail positions of the open decisions, so backtracking pops the trail.
+		//
 
 		class ResourceManager
 		{
 		public:
-			Clique::ResourceManager CliqueResourceManager;
-			SolveCallFrame	*CallFrame;
-			SolveThisContext This;
-			char	Line[256];
+			Ext::ArrayOfArray<int, ID> Clauses;
+			VariableAssignment *Assignment;
+			ID *Occurrences;
+			ID *WatchStart;
+			ID *WatchCount;
+			ID *Watches;
+			int *Trail;
+			ID *Decisions;
+			ID *VariableOrder;
+			ID *VariableRank;
+			ID *Seen;
+
+			ID Variables;
+			ID TrailSize;
+			ID PropagationHead;
+			ID DecisionCount;
+			ID NextDecision;
+			ID OrderCount;
+
+		private:
+			void *Memory;
 
 		public:
-			ResourceManager(decltype(Vertex::Id) _variables, decltype(Vertex::Id) _graphDegree, UInt32 _blockSize)
-				: CliqueResourceManager(_graphDegree, _blockSize), CallFrame(nullptr)
-			{
-				size_t allocationSize = sizeof(SolveCallFrame) * _variables;
-				CallFrame = (SolveCallFrame*)AllocMemory(allocationSize);
-				memset(CallFrame, 0, allocationSize);
+			ResourceManager(Formula _formula)
+				: Clauses(nullptr, 0), Variables(_formula.Variables), TrailSize(0), PropagationHead(0),
+				DecisionCount(0), NextDecision(0), OrderCount(0), Memory(nullptr)
+			{
+				ID variablesCount = Variables + 1, literals = 2 * variablesCount;
+				ID setCount = _formula.Clauses.setCount(), elementsCount = _formula.Clauses.elementsCount();
+
+				size_t clausesSize = Ext::ArrayOfArray<int, ID>::GetAllocationSize(setCount, elementsCount);
+				size_t assignmentSize = GetQWordAlignedSize(sizeof(VariableAssignment) * variablesCount);
+				size_t literalsSize = GetQWordAlignedSize(sizeof(ID) * (literals + 1));
+				size_t variablesSize = GetQWordAlignedSize(sizeof(ID) * variablesCount);
+
+				Memory = AllocMemory(clausesSize + assignmentSize + literalsSize * 3 + GetQWordAlignedSize(sizeof(ID) * elementsCount) + variablesSize * 5);
+
+				byte *ptr = (byte*)Memory;
+				Clauses.ctor(ptr, setCount, elementsCount);		ptr += clausesSize;
+				Assignment = (VariableAssignment*)ptr;			ptr += assignmentSize;
+				Occurrences = (ID*)ptr;								ptr += literalsSize;
+				WatchStart = (ID*)ptr;								ptr += literalsSize;
+				WatchCount = (ID*)ptr;								ptr += literalsSize;
+				Watches = (ID*)ptr;									ptr += GetQWordAlignedSize(sizeof(ID) * elementsCount);
+				Trail = (int*)ptr;									ptr += variablesSize;
+				Decisions = (ID*)ptr;								ptr += variablesSize;
+				VariableOrder = (ID*)ptr;							ptr += variablesSize;
+				VariableRank = (ID*)ptr;							ptr += variablesSize;
+				Seen = (ID*)ptr;
+
+				memset(Assignment, 0xFF, sizeof(VariableAssignment) * variablesCount);
+				memset(Occurrences, 0, literalsSize);
+				memset(WatchCount, 0, literalsSize);
+				memset(Seen, 0, variablesSize);
 			}
 
 			~ResourceManager()
 			{
-				FreeMemory(CallFrame);
-				CallFrame = nullptr;
+				FreeMemory(Memory);
+				Memory = nullptr;
+			}
+
+			ResourceManager(const ResourceManager&) = delete;
+			ResourceManager& operator=(const ResourceManager&) = delete;
+
+			void Watch(int _literal, ID _clause)
+			{
+				auto index = GetLiteralIndex(_literal);
+				Watches[WatchStart[index] + WatchCount[index]++] = _clause;
+			}
+
+			void Enqueue(int _literal, AssignmentState _state)
+			{
+				Assignment[(_literal < 0) ? -_literal : _literal].Set((_literal < 0) ? TruthValue::False : TruthValue::True, _state, TrailSize);
+				Trail[TrailSize++] = _literal;
+			}
+
+			//
+			//	Returns
+			//		True : every literal on the trail is propagated
+			//		False : a clause has all its literals false
+			//
+
+			bool Propagate()
+			{
+				int *list = Clauses.ptrList();
+
+				while (PropagationHead < TrailSize)
+				{
+					int falseLiteral = -Trail[PropagationHead++];
+					auto index = GetLiteralIndex(falseLiteral);
+					ID *watches = Watches + WatchStart[index];
+					ID count = WatchCount[index], kept = 0;
+
+					for (ID i = 0; i < count; i++)
+					{
+						ID clause = watches[i];
+						int *pClause = list + Clauses.GetSetStartIndex(clause);
+						ID clauseSize = Clauses.GetSetSize(clause);
+
+						if (pClause[0] == falseLiteral)
+						{
+							pClause[0] = pClause[1];
+							pClause[1] = falseLiteral;
+						}
+
+						if (GetLiteralValue(Assignment, pClause[0]) == TruthValue::True)
+						{
+							watches[kept++] = clause;
+							continue;
+						}
+
+						ID k = 2;
+						while ((k < clauseSize) && (GetLiteralValue(Assignment, pClause[k]) == TruthValue::False))
+							k++;
+
+						if (k < clauseSize)
+						{
+							pClause[1] = pClause[k];
+							pClause[k] = falseLiteral;
+							Watch(pClause[1], clause);
+							continue;
+						}
+
+						watches[kept++] = clause;
+
+						if (GetLiteralValue(Assignment, pClause[0]) == TruthValue::False)
+						{
+							while (++i < count)
+								watches[kept++] = watches[i];
+
+							WatchCount[index] = kept;
+							return false;
+						}
+
+						Enqueue(pClause[0], AssignmentState::Assigned);
+					}
+
+					WatchCount[index] = kept;
+				}
+
+				return true;
 			}
 
-			void ClearCounters()
+			//
+			//	Undoes the trail down to the last decision still having an untried value, and assigns that value.
+			//	Returns false when no such decision is left, i.e. the formula is unsatisfiable.
+			//
+
+			bool Backtrack()
 			{
+				while (DecisionCount > 0)
+				{
+					auto position = Decisions[DecisionCount - 1];
+					int literal = Trail[position];
+					auto state = Assignment[(literal < 0) ? -literal : literal].State;
+
+					for (ID i = TrailSize; i-- > position; )
+					{
+						auto variable = (Trail[i] < 0) ? -Trail[i] : Trail[i];
+						Assignment[variable].Set(TruthValue::Unassigned, AssignmentState::Unassigned, 0);
+
+						if (VariableRank[variable] < NextDecision)
+							NextDecision = VariableRank[variable];
+					}
+
+					TrailSize = PropagationHead = position;
+
+					if (state == AssignmentState::AssignedFirst)
+					{
+						Enqueue(-literal, AssignmentState::AssignedSecond);
+						return true;
+					}
+
+					DecisionCount--;
+				}
+
+				return false;
 			}
 		};
 	}
@@ -425,14 +763,16 @@ namespace Graph
 
 		char sz[512];
 
-		sprintf_s(sz, sizeof(sz), "%15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d\n", _resourceManager.Calls, _resourceManager.PartitionExtr, _resourceManager.TwoNHits, _resourceManager.TwoNColorHits, _resourceManager.SubgraphHits, _resourceManager.BtmUpHits, _resourceManager.BtmUpHits2, _resourceManager.BtmUpCheck, _resourceManager.BtmUpCheck2, _resourceManager.Count9, _resourceManager.Count11, _resourceManager.Count12, _resourceManager.Count13, _resourceManager.Count14);
+		auto length = _resourceManager.Counters.FormatValues(sz, sizeof(sz) - 1);
+		sz[length] = '\n';
+		sz[length + 1] = 0;
 		textStream(sz);
 
 		decltype(Vertex::Id) subGraphSize = 0;
 		for (size_t i = 0; (_resourceManager.CallFrame[i].callCount > 0); i++)
 		{
 			Clique::TryFindCliqueCallFrame &frame = _resourceManager.CallFrame[i];
-			sprintf_s(sz, sizeof(sz), "%8d Calls:%15I64d StartCall:%15I64d G-Size:%8d G(a)-Size:%8d K[In]:%8d K:%8d K(P):%8d d(V)[0]:%8d d(V)[last]:%8d v(pick):%8d d(v)-gap:%8d\n",
+			sprintf_s(sz, sizeof(sz), "%8d Calls:%15lld StartCall:%15lld G-Size:%8d G(a)-Size:%8d K[In]:%8d K:%8d K(P):%8d d(V)[0]:%8d d(V)[last]:%8d v(pick):%8d d(v)-gap:%8d\n",
 				(int)i + 1, frame.callCount, frame.startCallCount,
 				(i < _depth) ? (decltype(Vertex::Id))frame._graph.size() : subGraphSize,
 				frame.activeVertexCount, frame._cliqueSize, frame.cliqueSize, frame._cliqueMembersCount,
@@ -480,930 +820,1165 @@ namespace Graph
 
 
 	//
-	//	Returns
-	//		True : When formula is reduced without conflict
-	//		False : resulted in conflict of the formula
+	//	DPLL over the persistent clause store of SAT::ResourceManager: unit propagation by two watched literals,
+	//	chronological backtracking by popping the trail. Pure literals of the input are fixed up front; decisions
+	//	follow the variables by descending occurrences, each tried first with its more frequent polarity.
 	//
 
-	bool Reduce(SAT::VariableAssignment *_variableAssignment,
-		Ext::ArrayOfArray<int, ID> _srcClauses,
-		Ext::ArrayOfArray<int, ID>& _destClauses,
-		bool _traceEvaluation)
+	bool Solve(SAT::Formula _formula)
 	{
-		if (_srcClauses.setCount() == 0)
-		{
-			_destClauses.Clear();
+		if (_formula.Clauses.setCount() == 0)
 			return true;
-		}
-
-		if (_traceEvaluation)
-			TraceMessage("\r\n");
-
-		char msg[256];
-		auto elementsCount = _srcClauses.elementsCount();
-		int *list = _srcClauses.ptrList();
-		int *list2 = _destClauses.ptrList();
-
-		ID start2 = 0, clause2 = 0;
 
-		auto clauseSize = _srcClauses.GetSetSize(0);
-		auto start = _srcClauses.GetSetStartIndex(0);
-
-		int literal = 0;
-		SAT::TruthValue truthValue = SAT::TruthValue::Unassigned;
+		SAT::ResourceManager resourceManager(_formula);
+		auto clauses = _formula.Clauses;
+		auto &store = resourceManager.Clauses;
+		auto variablesCount = _formula.Variables + 1;
+		int *list = clauses.ptrList(), *storeList = store.ptrList();
+		ID elements = 0;
 
-		for (ID i = 0; i < _srcClauses.setCount(); )
+		// copy without duplicate literals and tautologies
+		for (ID i = 0; i < clauses.setCount(); i++)
 		{
-			auto prevClauseSize = clauseSize;
-			auto prevStart = start;
+			// an empty clause is false under every assignment
+			if (clauses.GetSetSize(i) == 0)
+				return false;
 
-			auto base = start2;
-			bool discardClause = false;
+			auto start = clauses.GetSetStartIndex(i);
+			auto base = elements;
+			bool isTautology = false;
 
-			for (auto end = start + clauseSize; start < end; start++)
+			for (ID end = start + clauses.GetSetSize(i); start < end; start++)
 			{
-				literal = list[start];
-				truthValue = (literal < 0) ? SAT::TruthValue::False : SAT::TruthValue::True;
-				if (literal < 0)
-					literal = -literal;
+				int literal = list[start];
+				auto variable = (literal < 0) ? -literal : literal;
+				if ((variable <= 0) || ((ID)variable > _formula.Variables))
+					throw std::invalid_argument(__FUNCDNAME__);
 
-				if (_variableAssignment[literal].State == SAT::AssignmentState::Unassigned)
-					list2[start2++] = list[start];
-				else if (_variableAssignment[literal].Value == truthValue)
+				if (resourceManager.Seen[variable] != i + 1)
 				{
-					start2 = base;
-					discardClause = true;
-					break;
+					resourceManager.Seen[variable] = i + 1;
+					storeList[elements++] = literal;
 				}
-				else // if (_variableAssignment[literal].Value != truthValue)
+				else
 				{
-					// evaluates to False. Discard the literal.
-				}
-			}
+					ID j = base;
+					while (storeList[j] != literal && storeList[j] != -literal)
+						j++;
 
-			if ((base == start2) && !discardClause)
-			{
-				if (_traceEvaluation)
-				{
-					sprintf_s(msg, sizeof(msg), "Clause %d resulted in conflict\r\n   ", (i + 1));
-					TraceMessage(msg);
-					PrintSATClause(list + prevStart, prevClauseSize, TraceMessage, msg, sizeof(msg));
+					isTautology |= (storeList[j] != literal);
 				}
-
-				return false; // reduction resulted formula failure
-			}
-
-			if (++i < _srcClauses.setCount())
-			{
-				clauseSize = _srcClauses.GetSetSize(i);
-				start = _srcClauses.GetSetStartIndex(i);
 			}
 
-			if (base < start2)
-			{
-				if (clause2 == 0)
-					_destClauses.Clear();
-
-				_destClauses.InitSet(clause2++, start2 - base);
-
-				if ((_traceEvaluation) && ((start2 - base) < prevClauseSize))
-				{
-					sprintf_s(msg, sizeof(msg), "Clause %d is reduced.\r\n   ", i);
-					TraceMessage(msg);
-					if (_srcClauses.ptr() != _destClauses.ptr())
-					{
-						PrintSATClause(list + prevStart, prevClauseSize, TraceMessage, msg, sizeof(msg));
-						TraceMessage("   ");
-					}
-
-					PrintSATClause(list2 + base, start2 - base, TraceMessage, msg, sizeof(msg));
-				}
-			}
-			else if (_traceEvaluation)
+			if (isTautology)
+				elements = base;
+			else
 			{
-				sprintf_s(msg, sizeof(msg), "Clause %d discarded due to %d satiesfies.\r\n   ", i, (truthValue == SAT::TruthValue::False) ? -literal : literal);
-				TraceMessage(msg);
-				PrintSATClause(list + prevStart, prevClauseSize, TraceMessage, msg, sizeof(msg));
+				store.InitSet(store.setCount(), elements - base);
+				for (ID j = base; j < elements; j++)
+					resourceManager.Occurrences[SAT::GetLiteralIndex(storeList[j])]++;
 			}
 		}
 
-		if (clause2 == 0)
-			_destClauses.Clear();
-
-		return true;
-	}
-
-	bool AssignValue(SAT::VariableAssignment *_variableAssignment,
-		decltype(Vertex::Id)& assignmentOrder,
-		Ext::List<SAT::VariableAssignmentOverride, ID>& _assignmentOverride,
-		ID variable, SAT::AssignmentState state,
-		SAT::TruthValue truthValue, bool traceEvaluation)
-	{
-		char msg[256];
+		ID offset = 0;
+		for (ID i = 0; i < 2 * variablesCount; i++)
+		{
+			resourceManager.WatchStart[i] = offset;
+			offset += resourceManager.Occurrences[i];
+		}
 
-		if (traceEvaluation)
+		for (ID i = 0; i < store.setCount(); i++)
 		{
-			if (state == SAT::AssignmentState::PureVariable)
-				sprintf_s(msg, sizeof(msg), "Assignment:%7d Variable %d ==> Marked as pure.\r\n", assignmentOrder, variable);
+			int *pClause = store.GetSet(i);
+			if (store.GetSetSize(i) > 1)
+			{
+				resourceManager.Watch(pClause[0], i);
+				resourceManager.Watch(pClause[1], i);
+			}
 			else
 			{
-				char *szTruthValue = "";
-				if (truthValue == SAT::TruthValue::True)
-					szTruthValue = "True";
-				else if (truthValue == SAT::TruthValue::False)
-					szTruthValue = "False";
-				else if (truthValue == SAT::TruthValue::Null)
-					szTruthValue = "Null";
-
-				if (state == SAT::AssignmentState::AssignedFirst)
-					TraceMessage("Selecting::\r\n");
+				auto truthValue = SAT::GetLiteralValue(resourceManager.Assignment, pClause[0]);
+				if (truthValue == SAT::TruthValue::False)
+					return false;
 
-				sprintf_s(msg, sizeof(msg), "Assignment:%7d Variable %d ==> %s\r\n", assignmentOrder, variable, szTruthValue);
+				if (truthValue == SAT::TruthValue::Unassigned)
+					resourceManager.Enqueue(pClause[0], SAT::AssignmentState::Assigned);
 			}
-
-			TraceMessage(msg);
 		}
 
-		if ((_variableAssignment[variable].RequiredLiteral != SAT::TruthValue::Unassigned) &&
-			(_variableAssignment[variable].RequiredLiteral != truthValue))
+		for (ID i = 1; i < variablesCount; i++)
 		{
-			return true;
+			auto positive = resourceManager.Occurrences[2 * i], negative = resourceManager.Occurrences[2 * i + 1];
+			if ((positive + negative == 0) || (resourceManager.Assignment[i].State != SAT::AssignmentState::Unassigned))
+				continue;
+
+			if ((positive == 0) || (negative == 0))
+				resourceManager.Enqueue((positive > 0) ? (int)i : -(int)i, SAT::AssignmentState::PureVariable);
+			else
+				resourceManager.VariableOrder[resourceManager.OrderCount++] = i;
 		}
 
-		_assignmentOverride.append(_variableAssignment[variable].ToOverride(variable));
-		_variableAssignment[variable].Set(truthValue, state, assignmentOrder++);
+		auto occurrences = resourceManager.Occurrences;
+		std::stable_sort(resourceManager.VariableOrder, resourceManager.VariableOrder + resourceManager.OrderCount, [occurrences](ID _a, ID _b)
+		{
+			return (occurrences[2 * _a] + occurrences[2 * _a + 1]) > (occurrences[2 * _b] + occurrences[2 * _b + 1]);
+		});
 
-		return false;
-	}
+		for (ID i = 0; i < resourceManager.OrderCount; i++)
+			resourceManager.VariableRank[resourceManager.VariableOrder[i]] = i;
 
-	SAT::SolveCallReturnParam Solve(SAT::Formula _formula,
-		SAT::VariableAssignment *_variableAssignment,
-		Ext::List<SAT::VariableAssignmentOverride, ID> _assignmentOverride,
-		decltype(Vertex::Id) _assignmentOrder,
-		decltype(Vertex::Id) _depth,
-		SAT::ResourceManager& _resourceManager)
-	{
-		Clique::ResourceManager& resourceManager = _resourceManager.CliqueResourceManager;
-		SAT::SolveCallFrame *frame = &_resourceManager.CallFrame[_depth];
-		SAT::SolveCallReturnParam returnValue;
-		Ext::ArrayOfArray<int, ID> reducedClauses(nullptr, 0);
-		SAT::Formula formula;
-		SAT::VariableStatistics *pVariableStatistics;
-		char msg[256];
+		while (true)
+		{
+			if (!resourceManager.Propagate())
+			{
+				if (!resourceManager.Backtrack())
+					return false;
 
-		frame->ReturnTo = SAT::ReturnCallSite::Exit;
+				continue;
+			}
 
-	Enter:
-		frame->_formula = _formula;
-		frame->_assignmentOrder = _assignmentOrder;
-		frame->Calls++;
+			auto &next = resourceManager.NextDecision;
+			while ((next < resourceManager.OrderCount) && (resourceManager.Assignment[resourceManager.VariableOrder[next]].State != SAT::AssignmentState::Unassigned))
+				next++;
 
-		ID assignmentOrder = _assignmentOrder;
+			if (next == resourceManager.OrderCount)
+				return true;
 
-		Ext::ArrayOfArray<int, ID> clauses = _formula.Clauses;
-		auto variablesCount = _formula.Variables + 1;
-		auto variables = _resourceManager.This._variables;
-		auto assignmentOrderItr = assignmentOrder;
-		ID pureLiterals = 0;
-		int *list = clauses.ptrList();
-		SAT::TruthValue truthValue;
-		auto traceEvaluation = _resourceManager.This.TraceEvaluation;
+			auto variable = resourceManager.VariableOrder[next];
+			int literal = (occurrences[2 * variable] >= occurrences[2 * variable + 1]) ? (int)variable : -(int)variable;
 
-		if (traceEvaluation)
-		{
-			sprintf_s(msg, sizeof(msg), "Evaluation Depth:%d\r\n\r\n", _depth);
-			TraceMessage(msg);
+			resourceManager.Decisions[resourceManager.DecisionCount++] = resourceManager.TrailSize;
+			resourceManager.Enqueue(literal, SAT::AssignmentState::AssignedFirst);
 		}
+	}
 
-		memset(variables, 0, sizeof(SAT::Variable) * variablesCount);
 
-		for (ID i = 0; i < clauses.elementsCount(); i++)
+	namespace Clique
+	{
+		void SetMemoryBudget(size_t _bytes)
 		{
-			auto literal = list[i];
-			if (literal < 0)
-			{
-				literal = -literal;
-				variables[literal].Negative.Clauses++;
-			}
-			else
-				variables[literal].Positive.Clauses++;
-
-			// assert((_variableAssignment[literal].State == SAT::AssignmentState::Unassigned) || (_variableAssignment[literal].State == SAT::AssignmentState::Dependent));
+			s_MemoryBudget = _bytes;
 		}
 
-		bool isPotentialClauseCombinerExist = false;
-		for (ID i = 0; i < variablesCount; i++)
+		size_t GetMemoryBudget()
 		{
-			if (_variableAssignment[i].State != SAT::AssignmentState::Unassigned)
-				continue;
+			return s_MemoryBudget;
+		}
 
-			isPotentialClauseCombinerExist |= variables[i].IsPotentialClauseCombiner();
+		size_t GetMemoryHighWater(const ResourceManager& _resourceManager)
+		{
+			return _resourceManager.Budget.HighWater;
+		}
 
-			if (variables[i].IsPure())
-			{
-				pureLiterals++;
-				truthValue = (variables[i].Positive.Clauses > 0) ? SAT::TruthValue::True : SAT::TruthValue::False;
-				if (AssignValue(_variableAssignment, assignmentOrder, _assignmentOverride, i, SAT::AssignmentState::PureVariable, truthValue, traceEvaluation))
-				{
-					returnValue.ctor(i, assignmentOrder + 1, false);
-					goto Return;
-				}
-			}
-			else
-			{
-				auto totalClauses = variables[i].TotalClauses();
-				if (totalClauses == 0)
-				{
-					if (AssignValue(_variableAssignment, assignmentOrder, _assignmentOverride, i, SAT::AssignmentState::Assigned, SAT::TruthValue::Null, traceEvaluation))
-					{
-						returnValue.ctor(i, assignmentOrder + 1, false);
-						goto Return;
-					}
-				}
-			}
+		void SetCounterDepthBreakdown(bool _enabled)
+		{
+			s_CounterDepthBreakdown = _enabled;
 		}
 
-		for (ID i = 0; i < clauses.setCount(); i++)
+		std::string ExportCounters(const ResourceManager& _resourceManager, CounterFormat _format, const char* _label)
 		{
-			auto clauseSize = clauses.GetSetSize(i);
-			if (clauseSize > 1)
-				continue;
+			std::string text;
+			_resourceManager.Counters.Export(_format, _label, text);
+			return text;
+		}
 
-			auto literal = list[clauses.GetSetStartIndex(i)];
-			if (literal < 0)
-			{
-				literal = -literal;
-				variables[literal].Negative.TrivialClauses++;
-				truthValue = SAT::TruthValue::False;
-			}
-			else
-			{
-				variables[literal].Positive.TrivialClauses++;
-				truthValue = SAT::TruthValue::True;
-			}
+		void SetProfiling(bool _enabled, UInt32 _samplingInterval)
+		{
+			s_ProfileSamplingInterval = _enabled ? ((_samplingInterval == 0) ? 1 : _samplingInterval) : 0;
+		}
 
-			if (_variableAssignment[literal].State == SAT::AssignmentState::Unassigned)
-			{
-				if (AssignValue(_variableAssignment, assignmentOrder, _assignmentOverride, literal, SAT::AssignmentState::Assigned, truthValue, traceEvaluation))
-				{
-					returnValue.ctor(literal, assignmentOrder + 1, false);
-					goto Return;
-				}
-			}
-			else if (_variableAssignment[literal].Value != truthValue)
-			{
-				returnValue.ctor(literal, assignmentOrder + 1, false);
-				goto Return;
-			}
+		void SetVertexOrder(VertexOrder _order)
+		{
+			s_VertexOrder = _order;
 		}
 
-		int assignProbeVariableId = 0;
-		if (assignmentOrderItr == assignmentOrder)
+		void SetProgressHandler(ResourceManager& _resourceManager, OnProgress _handler, void* _context, UInt32 _intervalMs)
 		{
-			if (traceEvaluation)
-			{
-				ID largestClauseSize = 0;
-				auto clauseSizeCounts = _resourceManager.CliqueResourceManager.lId;
-				clauseSizeCounts[0] = 0;
+			_resourceManager.ProgressHandler = _handler;
+			_resourceManager.ProgressContext = _context;
+			_resourceManager.ProgressInterval = _intervalMs;
+		}
 
-				for (ID i = 0; i < clauses.setCount(); i++)
-				{
-					auto clauseSize = clauses.GetSetSize(i);
-					if (largestClauseSize < clauseSize)
-					{
-						for (ID i = largestClauseSize + 1; i <= clauseSize; i++)
-							clauseSizeCounts[i] = 0;
+		std::string ReportProfile(const ResourceManager& _resourceManager)
+		{
+			std::string text;
+			if (_resourceManager.Profile != nullptr)
+				_resourceManager.Profile->Report(text);
 
-						largestClauseSize = clauseSize;
-					}
+			return text;
+		}
+	}
 
-					clauseSizeCounts[clauseSize]++;
-				}
+	decltype(Vertex::Id) FindClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _cliqueSize, Clique::FindOperation _op, Clique::CliqueHandler *_handler)
+	{
+		Clique::ResourceManager	resourceManager((decltype(Vertex::Id))_graph.size());
+		resourceManager.TraceStatistics = true;
 
-				TraceMessage("ClauseSizeCounts: ");
-				PrintArray(clauseSizeCounts, largestClauseSize + 1, TraceMessage);
-				TraceMessage("\r\n\r\n");
-			}
+		return FindClique(_graph, resourceManager, Ext::Array<ID>(), _cliqueSize, _op, _handler);
+	}
 
-			void	*pGraphMemory = _resourceManager.This.GraphMemory;
-			Ext::Unsafe::ArrayOfSet<Clique::ElementData, decltype(Vertex::Id)> cliqueMembers(_resourceManager.This.CliqueMembers, _resourceManager.This.TempGraphSize);
+	// TGraph : Ext::Array<Vertex> or TriangularGraph; the search runs on a dense copy either way.
+	template <class TGraph>
+	static decltype(Vertex::Id) FindCliqueOf(const TGraph& _graph, Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers,
+		decltype(Vertex::Id) _cliqueSize, Clique::FindOperation _op, Clique::CliqueHandler *_handler)
+	{
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
 
-			auto isAnyLiteralRequired = false;
-			for (ID i = 0; i < variablesCount; i++)
-			{
-				if (_variableAssignment[i].Order < _assignmentOrder)
-					continue;
+		if (_resourceManager.Capacity < _graph.size())
+			throw "_resourceManager capacity is less than _graph size.";
 
-				if ((_variableAssignment[i].RequiredLiteral == SAT::TruthValue::True) ||
-					(_variableAssignment[i].RequiredLiteral == SAT::TruthValue::False))
-					continue;
+		Clique::ResourceManager& resourceManager = _resourceManager;
+		resourceManager.Reset();
 
-				bool isPositiveValueRequired = false;
+		ReleaseMemoryToPool dtor(resourceManager.MemoryPool, resourceManager.MemoryPool.Allocate(GetQWordAlignedSize(_graph.size() * sizeof(ID)) + Ext::Unsafe::ArrayOfSet<Clique::ElementData, decltype(Vertex::Id)>::GetAllocationSize(_graph.size())));
+		ReleaseMemoryToPool dtor2(resourceManager.GraphMemoryPool, resourceManager.GraphMemoryPool.Allocate(GetGraphAllocationSize(_graph.size())));
+		if ((dtor.ptr() == nullptr) || (dtor2.ptr() == nullptr))
+			throw "memory budget exceeded.";
 
-				pVariableStatistics = &variables[i].Positive;
-				if (pVariableStatistics->TrivialClauses > 0)
-					isPositiveValueRequired = true;	// unreachable
-				else if (pVariableStatistics->Clauses <= 1)
-					isPositiveValueRequired = false;
-				else if (pVariableStatistics->Clauses > 1)
-				{
-					Ext::Array<Vertex> graph = CreateGraph(_formula, i, 0, resourceManager.lId, resourceManager.lId2, pGraphMemory);
-					auto cliqueSize = pVariableStatistics->Clauses;
+		ID		*originalVertexId = (ID*)dtor.ptr();
+		Ext::Unsafe::ArrayOfSet<Clique::ElementData, decltype(Vertex::Id)> cliqueMembers(((byte*)originalVertexId) + GetQWordAlignedSize(_graph.size() * sizeof(ID)), (ID)_graph.size());
+		void* pGraphMemory = dtor2.ptr();
+		bool traceStatistics = resourceManager.TraceStatistics;
 
-					if (graph.size() == 0)
-						isPositiveValueRequired = true;
-					else if (cliqueSize == 2)
-						isPositiveValueRequired = false;
-					else
-					{
-						AddSelfEdges(graph);
-						resourceManager.This.PrepareForInvoke();
-						isPositiveValueRequired = TryFindClique(graph, _resourceManager.This.OriginalVertexId, cliqueMembers, 0, cliqueSize, Clique::FindOperation::ExactSearch, nullptr, 0, 0, nullptr, resourceManager) == Ext::BooleanError::False;
-					}
-				}
+		decltype(Vertex::Id) i;
 
-				if (isPositiveValueRequired ? AssignValue(_variableAssignment, assignmentOrder, _assignmentOverride, i, SAT::AssignmentState::Assigned, SAT::TruthValue::True, traceEvaluation) : (_variableAssignment[i].RequiredLiteral == SAT::TruthValue::True))
-				{
-					returnValue.ctor(i, assignmentOrder + 1, false);
-					goto Return;
-				}
+		char sz[512];
+		if (traceStatistics)
+		{
+			auto length = sprintf_s(sz, sizeof(sz), "%15s %15s %15s %15s", "Vertices", "Clique", "Clique-R", "Ticks");
+			length += resourceManager.Counters.FormatHeader(sz + length, sizeof(sz) - length - 1);
+			sz[length] = '\n';
+			sz[length + 1] = 0;
+			TraceMessage(sz);
+		}
 
-				bool isNegativeValueRequired = false;
+		for (i = 0; i < _graph.size(); i++)
+			originalVertexId[i] = i;
 
-				pVariableStatistics = &variables[i].Negative;
-				if (pVariableStatistics->TrivialClauses > 0)
-					isNegativeValueRequired = true;	// unreachable
-				else if (pVariableStatistics->Clauses <= 1)
-					isNegativeValueRequired = false;
-				else if (pVariableStatistics->Clauses > 1)
-				{
-					Ext::Array<Vertex> graph = CreateGraph(_formula, 0, -(int)i, resourceManager.lId, resourceManager.lId2, pGraphMemory);
-					auto cliqueSize = pVariableStatistics->Clauses;
+		auto graph = CloneGraph(_graph, pGraphMemory);
 
-					if (graph.size() == 0)
-						isNegativeValueRequired = true;
-					else if (cliqueSize == 2)
-						isNegativeValueRequired = false;
-					else
-					{
-						AddSelfEdges(graph);
-						resourceManager.This.PrepareForInvoke();
-						isNegativeValueRequired = TryFindClique(graph, _resourceManager.This.OriginalVertexId, cliqueMembers, 0, cliqueSize, Clique::FindOperation::ExactSearch, nullptr, 0, 0, nullptr, resourceManager) == Ext::BooleanError::False;
-					}
-				}
+		cliqueMembers.ZeroMemory();
+		AddSelfEdges(graph);
 
-				if (isNegativeValueRequired ? AssignValue(_variableAssignment, assignmentOrder, _assignmentOverride, i, SAT::AssignmentState::Assigned, SAT::TruthValue::False, traceEvaluation) : (_variableAssignment[i].RequiredLiteral == SAT::TruthValue::False))
-				{
-					returnValue.ctor(i, assignmentOrder + 1, false);
-					goto Return;
-				}
+		// Relabels the copy only; members map back through originalVertexId.
+		if (PackVertices(graph, Ext::Array<ID>(originalVertexId, (ID)graph.size()), resourceManager.Order) == Ext::BooleanError::Error)
+			throw "invalid vertex order.";
+		resourceManager.This.PrintStatistics = traceStatistics;
 
-				bool isLiteralRequired = isPositiveValueRequired || isNegativeValueRequired;
-				if (!isLiteralRequired && (variables[i].Positive.Clauses > 0) && (variables[i].Negative.Clauses > 0))
-				{
-					Ext::Array<Vertex> graph = CreateGraph(_formula, i, -(int)i, resourceManager.lId, resourceManager.lId2, pGraphMemory);
-					auto cliqueSize = variables[i].Positive.Clauses + variables[i].Negative.Clauses;
+		auto ticks = GetCurrentTick();
+		auto cliqueSize = (_cliqueSize == INVALID_ID) ? 0 : _cliqueSize;
+		resourceManager.StartProgress();
+		auto result = TryFindClique(graph, originalVertexId, cliqueMembers, 0, cliqueSize, _op, nullptr, 0, 0, _handler, resourceManager);
+		resourceManager.StopProgress();
+		if (resourceManager.Profile != nullptr)
+			resourceManager.Profile->Stop();
 
-					if (graph.size() == 0)
-						isLiteralRequired = true;
-					else if (cliqueSize == 2)
-						isLiteralRequired = false;
-					else
-					{
-						AddSelfEdges(graph);
-						resourceManager.This.PrepareForInvoke();
-						isLiteralRequired = TryFindClique(graph, _resourceManager.This.OriginalVertexId, cliqueMembers, 0, cliqueSize, Clique::FindOperation::ExactSearch, nullptr, 0, 0, nullptr, resourceManager) == Ext::BooleanError::False;
-					}
-				}
+		if (result == Ext::BooleanError::Error)
+			return INVALID_ID;
 
-				if (isLiteralRequired && (_variableAssignment[i].IsRequired != SAT::TruthValue::True))
-				{
-					_assignmentOverride.append(_variableAssignment[i].ToOverride(i));
-					_variableAssignment[i].Order = assignmentOrder++;
-					_variableAssignment[i].IsRequired = SAT::TruthValue::True;
-					isAnyLiteralRequired = true;
-				}
-				else if (!isLiteralRequired && (_variableAssignment[i].IsRequired == SAT::TruthValue::True))
-				{
-					returnValue.ctor(i, assignmentOrder + 1, false);
-					goto Return;
-				}
+		if (resourceManager.IsTimedOut)
+			cliqueSize = resourceManager.This.CliqueSize;		// the largest found before the deadline.
+		else if (result == Ext::BooleanError::False)
+			cliqueSize = (cliqueSize > ((_cliqueSize == INVALID_ID) ? 0 : _cliqueSize)) ? (cliqueSize - 1) : 0;
+
+		if ((result == Ext::BooleanError::True) || (cliqueSize >= 3))
+		{
+			//	ExactSearch reports the members through cliqueMembers (as GetClusters reads them), not This.CliqueMembers.
+			if ((_op == Clique::FindOperation::ExactSearch) && (result == Ext::BooleanError::True))
+			{
+				for (i = 0; i < cliqueSize; i++)
+					resourceManager.This.CliqueMembers[i] = cliqueMembers.GetValue(i, 0).OriginalVertexId;
 			}
 
-			if (assignmentOrderItr == assignmentOrder)
+			Sort<decltype(Vertex::Id), decltype(Vertex::Id), Int32>(resourceManager.This.CliqueMembers, nullptr, 0, cliqueSize, true, resourceManager.Stack);
+			if (traceStatistics)
 			{
-				for (ID i = 0; i < clauses.setCount(); i++)
-				{
-					auto clauseSize = clauses.GetSetSize(i);
-					auto start = clauses.GetSetStartIndex(i);
-					for (ID end = start + clauseSize; start < end; start++)
-					{
-						auto literal = list[start];
+				sprintf_s(sz, sizeof(sz), "CliqueSize: %d\r\n", cliqueSize);
+				TraceMessage(sz);
+				PrintArray(resourceManager.This.CliqueMembers, cliqueSize, TraceMessage);
+			}
 
-						pVariableStatistics = (literal < 0) ? &variables[-literal].Negative : &variables[literal].Positive;
-						pVariableStatistics->ClauseLiterals += clauseSize;
-					}
-				}
+			assert(IsClique(_graph, resourceManager.This.CliqueMembers, cliqueSize, resourceManager.BitSet));
+		}
 
-				ID clauseCount = clauses.setCount(), clauseLiterals = 0;
-				int literal = 0;
-				for (ID i = 0; i < variablesCount; i++)
-				{
-					if ((_variableAssignment[i].IsRequired != SAT::TruthValue::True) && isAnyLiteralRequired)
-						continue;
+		for (i = 0; (i < cliqueSize) && (i < _cliqueMembers.size()); i++)
+			_cliqueMembers[i] = resourceManager.This.CliqueMembers[i];
 
-					truthValue = _variableAssignment[i].RequiredLiteral;
-					if (!isAnyLiteralRequired || (truthValue == SAT::TruthValue::True) || (truthValue != SAT::TruthValue::False))
-					{
-						auto count = variables[i].Positive.ClauseLiterals + variables[i].Negative.Clauses;
-						if ((count > clauseLiterals) || ((count == clauseLiterals) && (variables[i].TotalClauses() > clauseCount)))
-						{
-							literal = i;
-							clauseLiterals = count;
-							clauseCount = variables[i].TotalClauses();
-						}
-					}
+		if (traceStatistics)
+		{
+			auto length = sprintf_s(sz, sizeof(sz), "%15d %15d %15d %15lld", (int)graph.size(), cliqueSize, _cliqueSize, GetCurrentTick() - ticks);
+			length += resourceManager.Counters.FormatValues(sz + length, sizeof(sz) - length - 1);
+			sz[length] = '\n';
+			sz[length + 1] = 0;
+			TraceMessage(sz);
 
-					if (!isAnyLiteralRequired || (truthValue == SAT::TruthValue::False) || (truthValue != SAT::TruthValue::True))
-					{
-						auto count = variables[i].Negative.ClauseLiterals + variables[i].Positive.Clauses;
-						if ((count > clauseLiterals) || ((count == clauseLiterals) && (variables[i].TotalClauses() > clauseCount)))
-						{
-							literal = -(int)i;
-							clauseLiterals = count;
-							clauseCount = variables[i].TotalClauses();
-						}
-					}
-				}
+			for (i = 0; (resourceManager.CallFrame[i].callCount > 0); i++)
+			{
+				sprintf_s(sz, sizeof(sz), "%15d Calls:%15lld\n", (int)i + 1, resourceManager.CallFrame[i].callCount);
+				TraceMessage(sz);
+			}
 
-				truthValue = (literal < 0) ? SAT::TruthValue::False : SAT::TruthValue::True;
-				if (literal < 0)
-					literal = -literal;
+			sprintf_s(sz, sizeof(sz), "Memory: HighWater %lld Budget %lld\n", (Int64)resourceManager.Budget.HighWater, (Int64)resourceManager.Budget.Limit);
+			TraceMessage(sz);
+		}
 
-				if (AssignValue(_variableAssignment, assignmentOrder, _assignmentOverride, literal, SAT::AssignmentState::AssignedFirst, truthValue, traceEvaluation))
-				{
-					returnValue.ctor(literal, assignmentOrder + 1, false);
-					goto Return;
-				}
+		return cliqueSize;
+	}
+
+	decltype(Vertex::Id) FindClique(Ext::Array<Vertex> _graph, Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers,
+		decltype(Vertex::Id) _cliqueSize, Clique::FindOperation _op, Clique::CliqueHandler *_handler)
+	{
+		return FindCliqueOf(_graph, _resourceManager, _cliqueMembers, _cliqueSize, _op, _handler);
+	}
 
-				assignProbeVariableId = literal;
-				_resourceManager.This.AssignedDepth++;
+	decltype(Vertex::Id) FindClique(const TriangularGraph& _graph, Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers,
+		decltype(Vertex::Id) _cliqueSize, Clique::FindOperation _op, Clique::CliqueHandler *_handler)
+	{
+		return FindCliqueOf(_graph, _resourceManager, _cliqueMembers, _cliqueSize, _op, _handler);
+	}
+
+	forceinline void CopyRow(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _vertex, byte* _row)
+	{
+		CopyMemoryPack8(_row, _graph[_vertex].Neighbours, GetQWordAlignedSizeForBits(_graph.size()));
+	}
+
+	forceinline void CopyRow(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex, byte* _row)
+	{
+		GetTriangularGraphRow(_graph, _vertex, _row);
+	}
+
+	template <class TGraph>
+	static decltype(Vertex::Id) FindVertexCliqueOf(const TGraph& _graph, decltype(Vertex::Id) _vertex,
+		Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers, decltype(Vertex::Id) _cliqueSize)
+	{
+		if (_vertex >= _graph.size())
+			throw "invalid _vertex.";
+
+		if (_resourceManager.Capacity < _graph.size())
+			throw "_resourceManager capacity is less than _graph size.";
+
+		//	The maximum clique containing _vertex lies in N[_vertex] and every maximum clique of N[_vertex] contains _vertex.
+		size_t bitSetLength = GetQWordAlignedSizeForBits(_graph.size());
+		ReleaseMemoryToPool dtor(_resourceManager.MemoryPool, _resourceManager.MemoryPool.Allocate(bitSetLength * 2 + GetQWordAlignedSize(_graph.size() * sizeof(ID))));
+		if (dtor.ptr() == nullptr)
+			throw "memory budget exceeded.";
+
+		byte	*mask = (byte*)dtor.ptr();
+		byte	*sizeOfBitset = mask + bitSetLength;
+		ID		*ids = (ID*)(sizeOfBitset + bitSetLength);
+
+		CopyRow(_graph, _vertex, mask);
+		BitSet(mask, _vertex);
+
+		decltype(Vertex::Id) i, size = GetBitIndices((UInt64*)mask, ids, bitSetLength / sizeof(UInt64));
+
+		ReleaseMemoryToPool dtor2(_resourceManager.GraphMemoryPool, _resourceManager.GraphMemoryPool.Allocate(GetGraphAllocationSize(size)));
+		if (dtor2.ptr() == nullptr)
+			throw "memory budget exceeded.";
+
+		auto graph = CreateGraph(size, dtor2.ptr());
+		ExtractGraph(_graph, graph, mask, sizeOfBitset);
+
+		//	_cliqueSize is a lower bound known to the caller (e.g. from overlapping neighbourhoods); ExactSearch prunes below it.
+		bool isExactSearch = (_cliqueSize != INVALID_ID) && (3 <= _cliqueSize);
+		if (isExactSearch && (_cliqueSize > size))
+			return 0;
+
+		auto cliqueSize = FindClique(graph, _resourceManager, _cliqueMembers, isExactSearch ? _cliqueSize : INVALID_ID,
+			isExactSearch ? Clique::FindOperation::ExactSearch : Clique::FindOperation::MaximumClique, nullptr);
+		if ((cliqueSize == INVALID_ID) || (cliqueSize == 0))
+			return cliqueSize;
+
+		bool isVertexMember = false;
+		for (i = 0; (i < cliqueSize) && (i < _cliqueMembers.size()); i++)
+		{
+			_cliqueMembers[i] = ids[_cliqueMembers[i]];
+			isVertexMember |= (_cliqueMembers[i] == _vertex);
+		}
+
+		//	ExactSearch may return a clique of N(_vertex) which does not list _vertex; it extends by _vertex.
+		if (!isVertexMember && (cliqueSize < size))
+		{
+			if (cliqueSize < _cliqueMembers.size())
+				_cliqueMembers[cliqueSize] = _vertex;
+
+			cliqueSize++;
+			for (i = cliqueSize - 1; (i > 0) && (i < _cliqueMembers.size()) && (_cliqueMembers[i - 1] > _cliqueMembers[i]); i--)
+			{
+				auto id = _cliqueMembers[i];
+				_cliqueMembers[i] = _cliqueMembers[i - 1];
+				_cliqueMembers[i - 1] = id;
 			}
 		}
 
-		frame->assignProbeVariableId = assignProbeVariableId;
-		frame->assignmentOrder = assignmentOrder;
-		frame->_assignmentOverride = _assignmentOverride;
+		return cliqueSize;
+	}
+
+	decltype(Vertex::Id) FindVertexClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _vertex,
+		Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers, decltype(Vertex::Id) _cliqueSize)
+	{
+		return FindVertexCliqueOf(_graph, _vertex, _resourceManager, _cliqueMembers, _cliqueSize);
+	}
+
+	decltype(Vertex::Id) FindVertexClique(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex,
+		Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers, decltype(Vertex::Id) _cliqueSize)
+	{
+		return FindVertexCliqueOf(_graph, _vertex, _resourceManager, _cliqueMembers, _cliqueSize);
+	}
+
+	decltype(Vertex::Id) GetClusters(Ext::Array<Vertex> _graph,
+		Ext::ArrayOfArray<decltype(Vertex::Id), decltype(Vertex::Id)> *_pClusters,
+		Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize,
+		decltype(Vertex::Id) _depth, Clique::ResourceManager& _resourceManager)
+	{
+		Clique::TryFindCliqueThisContext ThisObject = _resourceManager.This;
+
+		UInt32	bitSetLength = (UInt32)GetQWordAlignedSizeForBits(_graph.size());
+		ReleaseMemoryToPool dtor(_resourceManager.MemoryPool, _resourceManager.MemoryPool.Allocate(GetQWordAlignedSize(_graph.size() * sizeof(ID)) * 3 + bitSetLength * 2 + Ext::Unsafe::ArrayOfSet<Clique::ElementData, ID>::GetAllocationSize(_graph.size())));
+		if (dtor.ptr() == nullptr)
+			throw "memory budget exceeded.";
+
+		ID		*vertexColor = (ID*)dtor.ptr();
+		ID		*cliqueMembers2 = (ID*)(((byte*)vertexColor) + GetQWordAlignedSize(_graph.size() * sizeof(ID)));
+		ID		*originalVertexId = (ID*)(((byte*)cliqueMembers2) + GetQWordAlignedSize(_graph.size() * sizeof(ID)));
+		byte	*singles = ((byte*)originalVertexId) + GetQWordAlignedSize(_graph.size() * sizeof(ID));
+		byte	*pairs = singles + bitSetLength;
+		Ext::Unsafe::ArrayOfSet<Clique::ElementData, ID> cliqueMembers(pairs + bitSetLength, (ID)_graph.size());
 
-		reducedClauses.ctor(_resourceManager.CliqueResourceManager.MemoryPool.Allocate(Ext::ArrayOfArray<int, ID>::GetAllocationSize((ID)clauses.setCount(), (ID)clauses.elementsCount())), clauses.setCount(), clauses.elementsCount());
+		decltype(Vertex::Id) i, j, color = 0, cliqueSize = ((3 <= _cliqueSize) && (_cliqueSize <= _graph.size())) ? _cliqueSize : 0;
+		size_t vertexColored = 0;
 
-	AlternateValueAssignment:
-		if (!Reduce(_variableAssignment, clauses, reducedClauses, traceEvaluation))
+		/*
+		*	Degree buckets : singles and pairs hold the vertices of Count 1 (the self edge only) and 2. A vertex is moved
+		*	between them as its Count drops, so each round takes the singles and the lowest pair from the bit sets
+		*	instead of scanning the counts of all the vertices.
+		*/
+		ZeroMemoryPack8(singles, bitSetLength * 2);
+		for (i = 0; i < _graph.size(); i++)
 		{
-			resourceManager.MemoryPool.Free(reducedClauses.ptr());
+			vertexColor[i] = 0;
+			originalVertexId[i] = i;
 
-			returnValue.ctor(0, assignmentOrder + 1, false);
-			goto Return;
+			if (_graph[i].Count == 1)
+				BitSet(singles, i);
+			else if (_graph[i].Count == 2)
+				BitSet(pairs, i);
 		}
 
-		if (reducedClauses.setCount() == 0)
+		//	Removes colored vertex _j from the rows of its neighbours.
+		auto removeVertex = [&](ID _j)
 		{
-			for (ID i = 0; i < variablesCount; i++)
+			auto ptr = _graph[_j].Neighbours;
+			ForEachBit((UInt64*)ptr, bitSetLength / sizeof(UInt64), [&](ID k)
 			{
-				if (_variableAssignment[i].State != SAT::AssignmentState::Unassigned)
-					continue;
+				auto count = --_graph[k].Count;
+				BitReset(_graph[k].Neighbours, _j);
 
-				_assignmentOverride.append(_variableAssignment[i].ToOverride(i));
-				_variableAssignment[i].Set(SAT::TruthValue::Null, SAT::AssignmentState::Assigned, assignmentOrder++);
-			}
+				if (count == 2)
+					BitSet(pairs, k);
+				else if (count == 1)
+				{
+					BitReset(pairs, k);
+					BitSet(singles, k);
+				}
+			});
+			ZeroMemoryPack8(ptr, bitSetLength);
+		};
 
-			// resolve all Pure values
+		while (vertexColored < _graph.size())
+		{
+			ForEachBit((UInt64*)singles, bitSetLength / sizeof(UInt64), [&](ID v)
+			{
+				assert((vertexColor[v] == 0) && (_graph[v].Count == 1));
+				color++;
+				vertexColor[v] = color;
+				vertexColored++;
 
-			resourceManager.MemoryPool.Free(reducedClauses.ptr());
+				if (_pClusters != nullptr)
+				{
+					_pClusters->InitSet(_pClusters->setCount(), 1);
+					_pClusters->Get(_pClusters->setCount() - 1, 0) = v;
+				}
 
-			returnValue.ctor(0, assignmentOrder, true);
-			goto Return;
-		}
+				_graph[v].Count = 0;
+				BitReset(_graph[v].Neighbours, v);
+			});
+			ZeroMemoryPack8(singles, bitSetLength);
 
-		// _variables = _variables;
-		// _variableAssignment = _variableAssignment;
-		_formula = SAT::Formula(_formula.Variables, reducedClauses);
-		_assignmentOrder = assignmentOrder;
+			i = (ID)FindNextBit(pairs, bitSetLength);
+			if (i < _graph.size())
+			{
+				assert((vertexColor[i] == 0) && (_graph[i].Count == 2));
+				BitReset(pairs, i);
+				_graph[i].Count = 0;
+				BitReset(_graph[i].Neighbours, i);
 
-		frame = &_resourceManager.CallFrame[++_depth];
-		frame->ReturnTo = SAT::ReturnCallSite::Reduction;
-		goto Enter;
+				j = (ID)FindNextBit(_graph[i].Neighbours, bitSetLength);
 
-	Reduction:
-		frame = &_resourceManager.CallFrame[--_depth];
+				BitReset(_graph[i].Neighbours, j);
+				assert(vertexColor[j] == 0);
 
-		formula.ctor(_formula.Variables, _formula.Clauses);
+				color++;
+				vertexColor[i] = color;
+				vertexColor[j] = color;
+				vertexColored += 2;
 
-		_formula = frame->_formula;
-		_assignmentOrder = frame->_assignmentOrder;
-		_assignmentOverride = frame->_assignmentOverride;
-		// _variableAssignment = frame->_variableAssignment;
+				if (_pClusters != nullptr)
+				{
+					_pClusters->InitSet(_pClusters->setCount(), 2);
+					_pClusters->Get(_pClusters->setCount() - 1, 0) = (i < j) ? i : j;
+					_pClusters->Get(_pClusters->setCount() - 1, 1) = (i < j) ? j : i;
+				}
 
-		assignmentOrder = frame->assignmentOrder;
+				_graph[j].Count = 0;
+				BitReset(pairs, j);
+				BitReset(_graph[j].Neighbours, i);
+				BitReset(_graph[j].Neighbours, j);
+				removeVertex(j);
+			}
 
-		clauses = _formula.Clauses;
+			if (vertexColored == _graph.size())
+				break;
+			if (i < _graph.size()) // colored two vertices.
+				continue;
 
-		// memset(_variables, 0, sizeof(SAT::Variable) * variablesCount); // uncomment if used after the call.
+			// cliqueMembers.ZeroMemory();
 
-		if (returnValue.IsSuccess)
-		{
-			// resolve all Pure values
-		}
-		else if (frame->assignProbeVariableId > 0)
-		{
-			auto literal = frame->assignProbeVariableId;
-			if (_variableAssignment[literal].State == SAT::AssignmentState::AssignedFirst)
+			_resourceManager.This.ctor(cliqueMembers2, _depth, 0, false);
+
+			auto op = (cliqueSize == 0) ? Clique::FindOperation::MaximumClique : Clique::FindOperation::ExactSearch;
+			auto result = TryFindClique(_graph, originalVertexId, cliqueMembers, 0, cliqueSize, op, nullptr, 0, _depth, nullptr, _resourceManager);
+			if ((result == Ext::BooleanError::True) || (op == Clique::FindOperation::MaximumClique))
 			{
-				_variableAssignment[literal].State = SAT::AssignmentState::AssignedSecond;
-				_variableAssignment[literal].Value = (_variableAssignment[literal].Value == SAT::TruthValue::True) ? SAT::TruthValue::False : SAT::TruthValue::True;
+				bool isExactSearch = (op == Clique::FindOperation::ExactSearch);
+				if (op == Clique::FindOperation::MaximumClique)
+					cliqueSize--;
 
-				reducedClauses = formula.Clauses;
+				color++;
 
-				// if (_resourceManager.TraceEvaluation)
-				if (_resourceManager.This.AssignedDepth < 60)
+				for (i = 0; i < cliqueSize; i++)
 				{
-					sprintf_s(msg, sizeof(msg), "AssignedDepth:%d Depth:%7d Variable %d ==> %s  TickCount:%I64d\r\n", _resourceManager.This.AssignedDepth, _depth, literal, (_variableAssignment[literal].Value == SAT::TruthValue::True) ? "True" : "False", GetCurrentTick());
-					TraceMessage(msg);
+					j = isExactSearch ? cliqueMembers.GetValue(i, 0).OriginalVertexId : _resourceManager.This.CliqueMembers[i];
+					_resourceManager.lId[i] = j;
+					assert(vertexColor[j] == 0);
+					vertexColor[j] = color;
 				}
 
-				goto AlternateValueAssignment;
+				Sort<decltype(Vertex::Id), decltype(Vertex::Id), Int32>(_resourceManager.lId, nullptr, 0, cliqueSize, true, _resourceManager.Stack);
+
+				if (_pClusters != nullptr)
+				{
+					_pClusters->InitSet(_pClusters->setCount(), cliqueSize);
+					for (i = 0; i < cliqueSize; i++)
+						_pClusters->Get(_pClusters->setCount() - 1, i) = _resourceManager.lId[i];
+				}
+
+				vertexColored += cliqueSize;
+				for (i = 0; i < cliqueSize; i++)
+				{
+					j = _resourceManager.lId[i];
+
+					_graph[j].Count = 0;
+					BitReset(singles, j);
+					BitReset(pairs, j);
+					BitReset(_graph[j].Neighbours, j);
+					removeVertex(j);
+				}
 			}
-			else if (_variableAssignment[literal].State == SAT::AssignmentState::AssignedSecond)
+			else
 			{
-				frame->assignProbeVariableId = 0;
-				_resourceManager.This.AssignedDepth--;
+				if (op == Clique::FindOperation::ExactSearch)
+					cliqueSize = 0;
+				else // if (op == Clique::FindOperation::MaximumClique)
+					cliqueSize--;
 			}
 		}
 
-		resourceManager.MemoryPool.Free(formula.Clauses.ptr());
+		for (i = 0; (i < _graph.size()) && (i < _vertexColor.size()); i++)
+			_vertexColor[i] = vertexColor[i];
 
-	Return:
+		_resourceManager.This = ThisObject;
+
+		return color;
+	}
+
+	decltype(Vertex::Id) GetIndependentSets(Ext::Array<Vertex> _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets,
+		Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize)
+	{
+		Clique::ResourceManager	resourceManager((decltype(Vertex::Id))_graph.size());
+
+		return GetIndependentSets(_graph, resourceManager, _pSets, _vertexColor, _cliqueSize);
+	}
+
+	// Complement straight out of _graph; ComplementGraph writes every row, so no zeroing or copy is needed.
+	static Ext::Array<Vertex> CreateComplementGraph(Ext::Array<Vertex> _graph, void* _ptr)
+	{
+		auto graph = CreateGraph(_graph.size(), _ptr, false);
+		Graph::ComplementGraph(_graph, graph);
+
+		return graph;
+	}
+
+	static Ext::Array<Vertex> CreateComplementGraph(const TriangularGraph& _graph, void* _ptr)
+	{
+		auto graph = CloneGraph(_graph, _ptr);
+		Graph::ComplementGraph(graph, graph);
+
+		return graph;
+	}
+
+	template <class TGraph>
+	static decltype(Vertex::Id) GetIndependentSetsOf(const TGraph& _graph, Clique::ResourceManager& _resourceManager,
+		Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize)
+	{
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
+
+		if (_resourceManager.Capacity < _graph.size())
+			throw "_resourceManager capacity is less than _graph size.";
+
+		_resourceManager.Reset();
+		ReleaseMemoryToPool dtor(_resourceManager.GraphMemoryPool, _resourceManager.GraphMemoryPool.Allocate(GetGraphAllocationSize(_graph.size())));
+		if (dtor.ptr() == nullptr)
+			throw "memory budget exceeded.";
+
+		auto graph = CreateComplementGraph(_graph, dtor.ptr());
+		AddSelfEdges(graph);
+
+		auto colors = GetClusters(graph, _pSets, _vertexColor, _cliqueSize, 0, _resourceManager);
+
+		// if (_vertexColor != nullptr) assert(IsValidColoring(_graph, _vertexColor));
+
+		return colors;
+	}
+
+	decltype(Vertex::Id) GetIndependentSets(Ext::Array<Vertex> _graph, Clique::ResourceManager& _resourceManager,
+		Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize)
+	{
+		return GetIndependentSetsOf(_graph, _resourceManager, _pSets, _vertexColor, _cliqueSize);
+	}
+
+	decltype(Vertex::Id) GetIndependentSets(const TriangularGraph& _graph, Clique::ResourceManager& _resourceManager,
+		Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize)
+	{
+		return GetIndependentSetsOf(_graph, _resourceManager, _pSets, _vertexColor, _cliqueSize);
+	}
+
+	//	Tabu moves per color removed from the first upper bound of GetChromaticNumber.
+	static const UInt32 ChromaticTabuIterations = 10000;
+
+	/*
+	*	DSATUR branch and bound (Brelaz). The clique of the lower bound is colored 1..ω, which breaks the symmetry
+	*	of the colors. Then the uncolored vertex of most distinct neighbour colors (ties : most uncolored
+	*	neighbours) is branched on, over each color not taken by a neighbour, up to one new color, and below the
+	*	best count found. neighbourColors[c][v] counts the neighbours of v colored c, a column of the memory pool
+	*	per color. The search state is an explicit stack of frames (vertex, color tried, colors used above).
+	*/
+	decltype(Vertex::Id) GetChromaticNumber(Ext::Array<Vertex> _graph, Clique::ResourceManager& _resourceManager,
+		Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, ID* _pLowerBound, UInt32 _timeLimitMs,
+		OnColoring _handler, void* _context)
+	{
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
+
+		if (_resourceManager.Capacity < _graph.size())
+			throw "_resourceManager capacity is less than _graph size.";
+
+		struct Frame
+		{
+			ID		Vertex, Color, Colors;
+		};
 
-		if (!returnValue.IsSuccess)
+		auto start = std::chrono::steady_clock::now();
+		auto n = (decltype(Vertex::Id))_graph.size();
+		size_t qwords = GetQWordSizeForBits(n), idsSize = GetQWordAlignedSize(n * sizeof(ID));
+		if (n == 0)
 		{
-			// revert overrides made in this iteration.
-			for (ID i = assignmentOrder; i-- > _assignmentOrder; )
-				_variableAssignment[_assignmentOverride[i].Variable].Set(_assignmentOverride[i]);
+			if (_pLowerBound != nullptr)
+				*_pLowerBound = 0;
 
-			_assignmentOverride.size(_assignmentOrder);
+			return 0;
 		}
 
-		switch (frame->ReturnTo)
+		ReleaseMemoryToPool dtor(_resourceManager.MemoryPool, _resourceManager.MemoryPool.Allocate(idsSize * 5 + GetQWordAlignedSize(n * sizeof(Frame))));
+		if (dtor.ptr() == nullptr)
+			throw "memory budget exceeded.";
+
+		ID		*best = (ID*)dtor.ptr();
+		ID		*color = (ID*)((byte*)best + idsSize);
+		ID		*saturation = (ID*)((byte*)color + idsSize);
+		ID		*degree = (ID*)((byte*)saturation + idsSize);
+		ID		*clique = (ID*)((byte*)degree + idsSize);
+		Frame	*frames = (Frame*)((byte*)clique + idsSize);
+
+		auto upper = GetColoring(_graph, ColoringMode::DSatur, nullptr, Ext::Array<ID>(best, n), ChromaticTabuIterations, 0, 0, _timeLimitMs);
+
+		_resourceManager.HasDeadline = (_timeLimitMs > 0);
+		_resourceManager.Deadline = start + std::chrono::milliseconds(_timeLimitMs);
+
+		decltype(Vertex::Id) lower;
+		try
 		{
-		case SAT::ReturnCallSite::Exit: break;
-		case SAT::ReturnCallSite::Reduction: goto Reduction;
-		default:
-			throw std::exception("ReturnTo");
+			lower = FindClique(_graph, _resourceManager, Ext::Array<ID>(clique, n));
+		}
+		catch (...)
+		{
+			_resourceManager.HasDeadline = false;
+			throw;
 		}
 
-		return returnValue;
-	}
-
-	bool Solve(SAT::Formula _formula)
-	{
-		auto graphSize = _formula.Clauses.elementsCount();
-		auto bitSetLength = GetQWordAlignedSizeForBits(graphSize);
-		auto resourceManager = SAT::ResourceManager(_formula.Variables, graphSize, (UInt32)(2 * 32 * sizeof(int) + bitSetLength * 3 + (3 * GetQWordAlignedSize(graphSize * sizeof(ID)) + 3 * bitSetLength) * Clique::FramesPerBlock * 2));
-		auto variablesCount = _formula.Variables + 1;
-		auto variableAssignment = (SAT::VariableAssignment*)resourceManager.CliqueResourceManager.MemoryPool.Allocate(
-			GetQWordAlignedSize(sizeof(SAT::VariableAssignment) * variablesCount) +
-			GetQWordAlignedSize(sizeof(SAT::Variable) * variablesCount) +
-			GetQWordAlignedSize(sizeof(SAT::VariableAssignmentOverride) * variablesCount * 2) +
-			Ext::ArrayOfArray<int, ID>::GetAllocationSize((ID)_formula.Clauses.setCount(), (ID)_formula.Clauses.elementsCount())
-		);
+		bool isStopped = (_timeLimitMs > 0) && (_resourceManager.IsTimedOut || (std::chrono::steady_clock::now() >= _resourceManager.Deadline));
+		_resourceManager.HasDeadline = false;
 
-		auto variables = (SAT::Variable*)((byte*)variableAssignment + GetQWordAlignedSize(sizeof(SAT::VariableAssignment) * variablesCount));
-		Ext::List<SAT::VariableAssignmentOverride, ID> assignmentOverride((SAT::VariableAssignmentOverride*)((byte*)variables + GetQWordAlignedSize(sizeof(SAT::Variable) * variablesCount)), variablesCount * 2, 0);
-		SAT::Formula reducedFormula(_formula.Variables, _formula.Clauses.Clone(((byte*)assignmentOverride.ptr() + GetQWordAlignedSize(sizeof(SAT::VariableAssignmentOverride) * variablesCount * 2)), _formula.Clauses.elementsCount()));
-		ReleaseMemoryToPool dtor(resourceManager.CliqueResourceManager.MemoryPool, variableAssignment);
+		//	A clique search stopped before its first clique still has any vertex.
+		if (lower == 0)
+		{
+			clique[0] = 0;
+			lower = 1;
+		}
 
-		memset(variableAssignment, 0xFFFFFFFF, sizeof(SAT::VariableAssignment) * (variablesCount));
+		isStopped |= (_handler != nullptr) && !_handler(upper, lower, best, _context);
 
-		ID tempGraphSize;
+		//	Colors 1..upper - 1 are tried; the columns are freed in reverse order, as the pool expects.
+		auto columns = (ID**)_resourceManager.MemoryPool.Allocate(GetQWordAlignedSize(upper * sizeof(ID*)));
+		if (columns == nullptr)
+			throw "memory budget exceeded.";
 
+		ID c, allocated = 0;
+		auto freeColumns = [&]()
 		{
-			ID literalMaxClauses = 0, largestClauseSize = 0;
-			auto clauses = _formula.Clauses;
-			auto list = clauses.ptrList();
+			while (allocated > 0)
+				_resourceManager.MemoryPool.Free(columns[--allocated]);
+
+			_resourceManager.MemoryPool.Free(columns);
+		};
 
-			memset(variables, 0, sizeof(SAT::Variable) * variablesCount);
-			for (ID i = 0; i < clauses.elementsCount(); i++)
+		for (c = 1; (c < upper) && (lower < upper) && !isStopped; c++, allocated++)
+		{
+			columns[c - 1] = (ID*)_resourceManager.MemoryPool.Allocate(idsSize);
+			if (columns[c - 1] == nullptr)
 			{
-				auto literal = list[i];
-				if (literal < 0)
-				{
-					literal = -literal;
-					variables[literal].Negative.Clauses++;
-				}
-				else
-					variables[literal].Positive.Clauses++;
+				freeColumns();
+				throw "memory budget exceeded.";
 			}
 
-			for (ID i = 0; i < variablesCount; i++)
+			ZeroMemoryPack8(columns[c - 1], idsSize);
+		}
+
+		auto assign = [&](ID _v, ID _c)
+		{
+			auto column = columns[_c - 1];
+			color[_v] = _c;
+			ForEachBit((UInt64*)_graph[_v].Neighbours, qwords, [&](ID u)
 			{
-				if (variables[i].TotalClauses() > literalMaxClauses)
-					literalMaxClauses = variables[i].TotalClauses();
+				if (u == _v)
+					return;
+
+				if (column[u]++ == 0)
+					saturation[u]++;
+				degree[u]--;
+			});
+		};
+
+		auto unassign = [&](ID _v, ID _c)
+		{
+			auto column = columns[_c - 1];
+			color[_v] = 0;
+			ForEachBit((UInt64*)_graph[_v].Neighbours, qwords, [&](ID u)
+			{
+				if (u == _v)
+					return;
+
+				if (--column[u] == 0)
+					saturation[u]--;
+				degree[u]++;
+			});
+		};
+
+		auto select = [&]()
+		{
+			ID v = INVALID_ID;
+			for (ID u = 0; u < n; u++)
+			{
+				if ((color[u] == 0) && ((v == INVALID_ID) || (saturation[u] > saturation[v]) || ((saturation[u] == saturation[v]) && (degree[u] > degree[v]))))
+					v = u;
 			}
 
-			for (ID i = 0; i < clauses.setCount(); i++)
+			return v;
+		};
+
+		if ((lower < upper) && !isStopped)
+		{
+			for (ID v = 0; v < n; v++)
 			{
-				auto clauseSize = clauses.GetSetSize(i);
-				if (clauseSize > largestClauseSize)
-					largestClauseSize = clauseSize;
+				color[v] = 0;
+				saturation[v] = 0;
+				degree[v] = _graph[v].Count - (BitTest(_graph[v].Neighbours, v) ? 1 : 0);
 			}
 
-			tempGraphSize = literalMaxClauses * largestClauseSize;
-		}
+			for (c = 0; c < lower; c++)
+				assign(clique[c], c + 1);
 
-		auto originalVertexId = (ID*)resourceManager.CliqueResourceManager.MemoryPool.Allocate(
-			GetQWordAlignedSize(sizeof(ID) * tempGraphSize) +
-			Ext::Unsafe::ArrayOfSet<Clique::ElementData, decltype(Vertex::Id)>::GetAllocationSize(tempGraphSize)
-		);
-		void *cliqueMembers = (byte*)originalVertexId + GetQWordAlignedSize(sizeof(ID) * tempGraphSize);
-		ReleaseMemoryToPool dtor2(resourceManager.CliqueResourceManager.GraphMemoryPool, resourceManager.CliqueResourceManager.GraphMemoryPool.Allocate(GetGraphAllocationSize(tempGraphSize)));
+			ID depth = 0, colored = lower;
+			UInt64 nodes = 0;
+			bool isComplete = true;
 
-		for (ID i = 0; i < tempGraphSize; i++)
-			originalVertexId[i] = i;
+			frames[0].Vertex = select();
+			frames[0].Color = 0;
+			frames[0].Colors = lower;
 
-		resourceManager.This.ctor(_formula, variableAssignment, variables, originalVertexId, cliqueMembers, dtor2.ptr(), tempGraphSize, false);
-		resourceManager.This.TraceEvaluation = false;
+			while (true)
+			{
+				auto& frame = frames[depth];
+				if (frame.Color != 0)
+				{
+					unassign(frame.Vertex, frame.Color);
+					colored--;
+				}
 
-		return Solve(reducedFormula, variableAssignment, assignmentOverride, 0, 0, resourceManager).IsSuccess;
-	}
+				ID limit = (frame.Colors + 1 < upper - 1) ? (frame.Colors + 1) : (upper - 1);
+				for (c = frame.Color + 1; (c <= limit) && (columns[c - 1][frame.Vertex] != 0); c++);
 
+				if ((frame.Colors >= upper) || (c > limit))
+				{
+					frame.Color = 0;
+					if (depth == 0)
+						break;
 
-	decltype(Vertex::Id) FindClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _cliqueSize, Clique::FindOperation _op, Clique::CliqueHandler *_handler)
-	{
-		if (IsCorrupt(_graph))
-			throw "invalid _graph.";
+					depth--;
+					continue;
+				}
 
-		/*
-		*	_blockSize:
-		*			ResourceManager.m_Stack		:		2 * 32 * sizeof(int);
-		*			ResourceManager.m_BitSet,2	:		3 * GetQWordAlignedSizeForBits(_graph.size());
-		*
-		*		[
-		*			Ext::Array<Vertex>			:		6 * GetQWORDAlignedSize(_graph.size() * sizeof(ID));
-		*												:		4 * GetQWordAlignedSizeForBits(_graph.size());
-		*		] * FramesPerBlock * 2
-		*/
-		UInt32	bitSetLength = (UInt32)GetQWordAlignedSizeForBits(_graph.size());
-		Clique::ResourceManager	resourceManager((decltype(Vertex::Id))_graph.size(), (UInt32)(2 * 32 * sizeof(int) + bitSetLength * 3 + (3 * GetQWordAlignedSize(_graph.size() * sizeof(ID)) + 3 * bitSetLength) * Clique::FramesPerBlock * 2));
+				frame.Color = c;
+				assign(frame.Vertex, c);
+				colored++;
 
-		ReleaseMemoryToPool dtor(resourceManager.MemoryPool, resourceManager.MemoryPool.Allocate(GetQWordAlignedSize(_graph.size() * sizeof(ID)) + Ext::Unsafe::ArrayOfSet<Clique::ElementData, decltype(Vertex::Id)>::GetAllocationSize(_graph.size())));
-		ReleaseMemoryToPool dtor2(resourceManager.GraphMemoryPool, resourceManager.GraphMemoryPool.Allocate(GetGraphAllocationSize(_graph.size())));
+				auto colors = (frame.Colors > c) ? frame.Colors : c;
+				if (colored == n)
+				{
+					upper = colors;
+					for (ID v = 0; v < n; v++)
+						best[v] = color[v];
 
-		ID		*originalVertexId = (ID*)dtor.ptr();
-		Ext::Unsafe::ArrayOfSet<Clique::ElementData, decltype(Vertex::Id)> cliqueMembers(((byte*)originalVertexId) + GetQWordAlignedSize(_graph.size() * sizeof(ID)), (ID)_graph.size());
-		void* pGraphMemory = dtor2.ptr();
+					if (upper <= lower)
+						break;
 
-		decltype(Vertex::Id) i;
+					if ((_handler != nullptr) && !_handler(upper, lower, best, _context))
+					{
+						isComplete = false;
+						break;
+					}
 
-		char sz[512];
-		sprintf_s(sz, sizeof(sz), "%15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s %15s\n", "Vertices", "Clique", "Clique-R", "Ticks", "Calls", "PartitionExtr", "TwoNHits", "TwoNColorHits", "SubgraphHits", "BtmUpHits", "BtmUpHits2", "BtmUpCheck", "BtmUpCheck2", "Count9", "Count11", "Count12", "Count13", "Count14");
-		TraceMessage(sz);
+					continue;
+				}
 
-		for (i = 0; i < _graph.size(); i++)
-			originalVertexId[i] = i;
+				if (((++nodes & 0x3FF) == 0) && (_timeLimitMs > 0) &&
+					(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= _timeLimitMs))
+				{
+					isComplete = false;
+					break;
+				}
 
-		auto graph = CloneGraph(_graph, pGraphMemory);
+				depth++;
+				frames[depth].Vertex = select();
+				frames[depth].Color = 0;
+				frames[depth].Colors = colors;
+			}
 
-		cliqueMembers.ZeroMemory();
-		AddSelfEdges(graph);
-		resourceManager.This.PrintStatistics = true;
+			//	An exhausted search proves no coloring below upper exists.
+			if (isComplete)
+				lower = upper;
+		}
 
-		auto ticks = GetCurrentTick();
-		auto cliqueSize = (_cliqueSize == INVALID_ID) ? 0 : _cliqueSize;
-		auto result = TryFindClique(graph, originalVertexId, cliqueMembers, 0, cliqueSize, _op, nullptr, 0, 0, _handler, resourceManager);
+		freeColumns();
 
-		if (result == Ext::BooleanError::Error)
-			return INVALID_ID;
+		assert(IsValidColoring(_graph, best));
 
-		if (result == Ext::BooleanError::False)
-			cliqueSize = (cliqueSize > ((_cliqueSize == INVALID_ID) ? 0 : _cliqueSize)) ? (cliqueSize - 1) : 0;
+		for (ID v = 0; (v < n) && (v < _vertexColor.size()); v++)
+			_vertexColor[v] = best[v];
 
-		if ((result == Ext::BooleanError::True) || (cliqueSize >= 3))
-		{
-			Sort<decltype(Vertex::Id), decltype(Vertex::Id), Int32>(resourceManager.This.CliqueMembers, nullptr, 0, cliqueSize, true, resourceManager.Stack);
-			sprintf_s(sz, sizeof(sz), "CliqueSize: %d\r\n", cliqueSize);
-			TraceMessage(sz);
-			PrintArray(resourceManager.This.CliqueMembers, cliqueSize, TraceMessage);
+		if (_pSets != nullptr)
+			GetColorClasses(best, n, upper, *_pSets);
 
-			assert(IsClique(_graph, resourceManager.This.CliqueMembers, cliqueSize, resourceManager.BitSet));
-		}
+		if (_pLowerBound != nullptr)
+			*_pLowerBound = lower;
 
-		sprintf_s(sz, sizeof(sz), "%15d %15d %15d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d\n", (int)graph.size(), cliqueSize, _cliqueSize, GetCurrentTick() - ticks, resourceManager.Calls, resourceManager.PartitionExtr, resourceManager.TwoNHits, resourceManager.TwoNColorHits, resourceManager.SubgraphHits, resourceManager.BtmUpHits, resourceManager.BtmUpHits2, resourceManager.BtmUpCheck, resourceManager.BtmUpCheck2, resourceManager.Count9, resourceManager.Count11, resourceManager.Count12, resourceManager.Count13, resourceManager.Count14);
-		TraceMessage(sz);
+		return upper;
+	}
 
-		for (i = 0; (resourceManager.CallFrame[i].callCount > 0); i++)
+	namespace Clique
+	{
+		Solver::Solver(decltype(Vertex::Id) _capacity)
+			: Resources(nullptr), Members(nullptr), CliqueSize(0), CapacityValue(0), TraceStatistics(false),
+			  ProgressHandler(nullptr), ProgressContext(nullptr), ProgressInterval(0)
 		{
-			sprintf_s(sz, sizeof(sz), "%15d Calls:%15I64d\n", (int)i + 1, resourceManager.CallFrame[i].callCount);
-			TraceMessage(sz);
+			if (_capacity > 0)
+				Reserve(_capacity);
 		}
 
-		return cliqueSize;
-	}
+		Solver::~Solver()
+		{
+			if (Resources != nullptr)
+				delete Resources;
 
-	decltype(Vertex::Id) GetClusters(Ext::Array<Vertex> _graph,
-		Ext::ArrayOfArray<decltype(Vertex::Id), decltype(Vertex::Id)> *_pClusters,
-		Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize,
-		decltype(Vertex::Id) _depth, Clique::ResourceManager& _resourceManager)
-	{
-		Clique::TryFindCliqueThisContext ThisObject = _resourceManager.This;
+			if (Members != nullptr)
+				FreeMemory(Members);
+		}
 
-		UInt32	bitSetLength = (UInt32)GetQWordAlignedSizeForBits(_graph.size());
-		ReleaseMemoryToPool dtor(_resourceManager.MemoryPool, _resourceManager.MemoryPool.Allocate(GetQWordAlignedSize(_graph.size() * sizeof(ID)) * 3 + Ext::Unsafe::ArrayOfSet<Clique::ElementData, ID>::GetAllocationSize(_graph.size())));
+		void Solver::Reserve(decltype(Vertex::Id) _graphSize)
+		{
+			if ((Resources != nullptr) && (_graphSize <= CapacityValue))
+				return;
 
-		ID		*vertexColor = (ID*)dtor.ptr();
-		ID		*cliqueMembers2 = (ID*)(((byte*)vertexColor) + GetQWordAlignedSize(_graph.size() * sizeof(ID)));
-		ID		*originalVertexId = (ID*)(((byte*)cliqueMembers2) + GetQWordAlignedSize(_graph.size() * sizeof(ID)));
-		Ext::Unsafe::ArrayOfSet<Clique::ElementData, ID> cliqueMembers((((byte*)originalVertexId) + GetQWordAlignedSize(_graph.size() * sizeof(ID))), (ID)_graph.size());
+			if (Resources != nullptr)
+				delete Resources;
 
-		decltype(Vertex::Id) i, j, color = 0, cliqueSize = ((3 <= _cliqueSize) && (_cliqueSize <= _graph.size())) ? _cliqueSize : 0;
-		size_t vertexColored = 0;
+			if (Members != nullptr)
+				FreeMemory(Members);
 
-		for (i = 0; i < _graph.size(); i++)
-		{
-			vertexColor[i] = 0;
-			originalVertexId[i] = i;
+			Resources = nullptr;
+			Members = nullptr;
+			CliqueSize = 0;
+			CapacityValue = 0;
+
+			Resources = new ResourceManager(_graphSize);
+			Resources->TraceStatistics = TraceStatistics;
+			Clique::SetProgressHandler(*Resources, ProgressHandler, ProgressContext, ProgressInterval);
+			Members = (ID*)AllocMemory(GetQWordAlignedSize((_graphSize + 1) * sizeof(ID)));
+			CapacityValue = _graphSize;
 		}
 
-		while (vertexColored < _graph.size())
+		decltype(Vertex::Id) Solver::FindClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _cliqueSize, FindOperation _op, CliqueHandler *_handler)
 		{
-			for (i = 0; i < _graph.size(); i++)
+			Reserve((decltype(Vertex::Id))_graph.size());
+
+			CliqueSize = 0;
+			decltype(Vertex::Id) cliqueSize;
+			try
 			{
-				if (_graph[i].Count != 1)
-					continue;
+				cliqueSize = Graph::FindClique(_graph, *Resources, Ext::Array<ID>(Members, CapacityValue), _cliqueSize, _op, _handler);
+			}
+			catch (const char*)
+			{
+				DiscardResources();
+				throw;
+			}
 
-				assert(vertexColor[i] == 0);
-				color++;
-				vertexColor[i] = color;
-				vertexColored++;
+			CliqueSize = ((cliqueSize == INVALID_ID) || (cliqueSize > _graph.size())) ? 0 : cliqueSize;
 
-				if (_pClusters != nullptr)
-				{
-					_pClusters->InitSet(_pClusters->setCount(), 1);
-					_pClusters->Get(_pClusters->setCount() - 1, 0) = i;
-				}
+			return cliqueSize;
+		}
 
-				_graph[i].Count = 0;
-				BitReset(_graph[i].Neighbours, i);
-			}
+		decltype(Vertex::Id) Solver::FindVertexClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _vertex, decltype(Vertex::Id) _cliqueSize)
+		{
+			Reserve((decltype(Vertex::Id))_graph.size());
 
-			for (i = 0; i < _graph.size(); i++)
+			CliqueSize = 0;
+			decltype(Vertex::Id) cliqueSize;
+			try
 			{
-				if (_graph[i].Count != 2)
-					continue;
+				cliqueSize = Graph::FindVertexClique(_graph, _vertex, *Resources, Ext::Array<ID>(Members, CapacityValue), _cliqueSize);
+			}
+			catch (const char*)
+			{
+				DiscardResources();
+				throw;
+			}
 
-				assert(vertexColor[i] == 0);
-				_graph[i].Count = 0;
-				BitReset(_graph[i].Neighbours, i);
+			CliqueSize = ((cliqueSize == INVALID_ID) || (cliqueSize > _graph.size())) ? 0 : cliqueSize;
 
-				byte *ptr;
-				for (ptr = _graph[i].Neighbours; *ptr == 0; ptr++);
-				j = ((ID)(ptr - _graph[i].Neighbours) * 8) + Bit::FirstLSB[*ptr];
+			return cliqueSize;
+		}
 
-				BitReset(_graph[i].Neighbours, j);
-				assert(vertexColor[j] == 0);
+		decltype(Vertex::Id) Solver::GetIndependentSets(Ext::Array<Vertex> _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize)
+		{
+			Reserve((decltype(Vertex::Id))_graph.size());
 
-				color++;
-				vertexColor[i] = color;
-				vertexColor[j] = color;
-				vertexColored += 2;
+			CliqueSize = 0;
+			try
+			{
+				return Graph::GetIndependentSets(_graph, *Resources, _pSets, _vertexColor, _cliqueSize);
+			}
+			catch (const char*)
+			{
+				DiscardResources();
+				throw;
+			}
+		}
 
-				if (_pClusters != nullptr)
-				{
-					_pClusters->InitSet(_pClusters->setCount(), 2);
-					_pClusters->Get(_pClusters->setCount() - 1, 0) = (i < j) ? i : j;
-					_pClusters->Get(_pClusters->setCount() - 1, 1) = (i < j) ? j : i;
-				}
+		decltype(Vertex::Id) Solver::FindClique(const TriangularGraph& _graph, decltype(Vertex::Id) _cliqueSize, FindOperation _op, CliqueHandler *_handler)
+		{
+			Reserve((decltype(Vertex::Id))_graph.size());
 
-				_graph[j].Count = 0;
-				ptr = _graph[j].Neighbours;
-				BitReset(ptr, i);
-				BitReset(ptr, j);
+			CliqueSize = 0;
+			decltype(Vertex::Id) cliqueSize;
+			try
+			{
+				cliqueSize = Graph::FindClique(_graph, *Resources, Ext::Array<ID>(Members, CapacityValue), _cliqueSize, _op, _handler);
+			}
+			catch (const char*)
+			{
+				DiscardResources();
+				throw;
+			}
 
-				for (ID k = 0; k < _graph.size(); k++)
-				{
-					if (!BitTest(ptr, k))
-						continue;
+			CliqueSize = ((cliqueSize == INVALID_ID) || (cliqueSize > _graph.size())) ? 0 : cliqueSize;
 
-					_graph[k].Count--;
-					BitReset(_graph[k].Neighbours, j);
-					BitReset(ptr, k);
-				}
+			return cliqueSize;
+		}
 
-				break;
+		decltype(Vertex::Id) Solver::FindVertexClique(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex, decltype(Vertex::Id) _cliqueSize)
+		{
+			Reserve((decltype(Vertex::Id))_graph.size());
+
+			CliqueSize = 0;
+			decltype(Vertex::Id) cliqueSize;
+			try
+			{
+				cliqueSize = Graph::FindVertexClique(_graph, _vertex, *Resources, Ext::Array<ID>(Members, CapacityValue), _cliqueSize);
+			}
+			catch (const char*)
+			{
+				DiscardResources();
+				throw;
 			}
 
-			if (vertexColored == _graph.size())
-				break;
-			if (i < _graph.size()) // colored two vertices.
-				continue;
+			CliqueSize = ((cliqueSize == INVALID_ID) || (cliqueSize > _graph.size())) ? 0 : cliqueSize;
 
-			// cliqueMembers.ZeroMemory();
+			return cliqueSize;
+		}
 
-			_resourceManager.This.ctor(cliqueMembers2, _depth, 0, false);
+		decltype(Vertex::Id) Solver::GetIndependentSets(const TriangularGraph& _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize)
+		{
+			Reserve((decltype(Vertex::Id))_graph.size());
 
-			auto op = (cliqueSize == 0) ? Clique::FindOperation::MaximumClique : Clique::FindOperation::ExactSearch;
-			auto result = TryFindClique(_graph, originalVertexId, cliqueMembers, 0, cliqueSize, op, nullptr, 0, _depth, nullptr, _resourceManager);
-			if ((result == Ext::BooleanError::True) || (op == Clique::FindOperation::MaximumClique))
+			CliqueSize = 0;
+			try
 			{
-				bool isExactSearch = (op == Clique::FindOperation::ExactSearch);
-				if (op == Clique::FindOperation::MaximumClique)
-					cliqueSize--;
-
-				color++;
+				return Graph::GetIndependentSets(_graph, *Resources, _pSets, _vertexColor, _cliqueSize);
+			}
+			catch (const char*)
+			{
+				DiscardResources();
+				throw;
+			}
+		}
 
-				for (i = 0; i < cliqueSize; i++)
-				{
-					j = isExactSearch ? cliqueMembers.GetValue(i, 0).OriginalVertexId : _resourceManager.This.CliqueMembers[i];
-					_resourceManager.lId[i] = j;
-					assert(vertexColor[j] == 0);
-					vertexColor[j] = color;
-				}
+		decltype(Vertex::Id) Solver::GetColoring(Ext::Array<Vertex> _graph, ColoringMode _mode, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, UInt32 _tabuIterations, UInt32 _threads, UInt64 _seed)
+		{
+			if (_mode == ColoringMode::Exact)
+				return GetIndependentSets(_graph, _pSets, _vertexColor);
 
-				Sort<decltype(Vertex::Id), decltype(Vertex::Id), Int32>(_resourceManager.lId, nullptr, 0, cliqueSize, true, _resourceManager.Stack);
+			CliqueSize = 0;
+			return Graph::GetColoring(_graph, _mode, _pSets, _vertexColor, _tabuIterations, _threads, _seed);
+		}
 
-				if (_pClusters != nullptr)
-				{
-					_pClusters->InitSet(_pClusters->setCount(), cliqueSize);
-					for (i = 0; i < cliqueSize; i++)
-						_pClusters->Get(_pClusters->setCount() - 1, i) = _resourceManager.lId[i];
-				}
+		decltype(Vertex::Id) Solver::GetColoring(const TriangularGraph& _graph, ColoringMode _mode, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, UInt32 _tabuIterations, UInt32 _threads, UInt64 _seed)
+		{
+			if (_mode == ColoringMode::Exact)
+				return GetIndependentSets(_graph, _pSets, _vertexColor);
 
-				vertexColored += cliqueSize;
-				for (i = 0; i < cliqueSize; i++)
-				{
-					j = _resourceManager.lId[i];
+			CliqueSize = 0;
+			auto graph = CloneGraph(_graph);
+			try
+			{
+				auto colors = Graph::GetColoring(graph, _mode, _pSets, _vertexColor, _tabuIterations, _threads, _seed);
+				FreeGraph(graph);
+				return colors;
+			}
+			catch (const char*)
+			{
+				FreeGraph(graph);
+				throw;
+			}
+		}
 
-					_graph[j].Count = 0;
-					auto ptr = _graph[j].Neighbours;
-					BitReset(ptr, j);
+		decltype(Vertex::Id) Solver::GetChromaticNumber(Ext::Array<Vertex> _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, ID* _pLowerBound, UInt32 _timeLimitMs, OnColoring _handler, void* _context)
+		{
+			Reserve((decltype(Vertex::Id))_graph.size());
 
-					for (ID k = 0; k < _graph.size(); k++)
-					{
-						if (!BitTest(ptr, k))
-							continue;
+			CliqueSize = 0;
+			try
+			{
+				return Graph::GetChromaticNumber(_graph, *Resources, _pSets, _vertexColor, _pLowerBound, _timeLimitMs, _handler, _context);
+			}
+			catch (const char*)
+			{
+				DiscardResources();
+				throw;
+			}
+		}
 
-						_graph[k].Count--;
-						BitReset(_graph[k].Neighbours, j);
-						BitReset(ptr, k);
-					}
-				}
+		decltype(Vertex::Id) Solver::GetChromaticNumber(const TriangularGraph& _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, ID* _pLowerBound, UInt32 _timeLimitMs, OnColoring _handler, void* _context)
+		{
+			auto graph = CloneGraph(_graph);
+			try
+			{
+				auto colors = GetChromaticNumber(graph, _pSets, _vertexColor, _pLowerBound, _timeLimitMs, _handler, _context);
+				FreeGraph(graph);
+				return colors;
 			}
-			else
+			catch (const char*)
 			{
-				if (op == Clique::FindOperation::ExactSearch)
-					cliqueSize = 0;
-				else // if (op == Clique::FindOperation::MaximumClique)
-					cliqueSize--;
+				FreeGraph(graph);
+				throw;
 			}
 		}
 
-		for (i = 0; (i < _graph.size()) && (i < _vertexColor.size()); i++)
-			_vertexColor[i] = vertexColor[i];
+		// A search abandoned by an exception leaves its pool allocations behind; the next call starts afresh.
+		void Solver::DiscardResources()
+		{
+			if (Resources != nullptr)
+				delete Resources;
 
-		_resourceManager.This = ThisObject;
+			Resources = nullptr;
+		}
 
-		return color;
-	}
+		UInt64 Solver::Calls() const
+		{
+			return (Resources == nullptr) ? 0 : Resources->Counters.Get(Counter::Calls);
+		}
 
-	decltype(Vertex::Id) GetIndependentSets(Ext::Array<Vertex> _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets,
-		Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize)
-	{
-		if (IsCorrupt(_graph))
-			throw "invalid _graph.";
+		size_t Solver::MemoryHighWater() const
+		{
+			return (Resources == nullptr) ? 0 : Resources->Budget.HighWater;
+		}
 
-		/*
-		*	_blockSize:
-		*			ResourceManager.m_Stack		:		2 * 32 * sizeof(int);
-		*			ResourceManager.m_BitSet	:		2 * GetQWordAlignedSizeForBits(_graph.size());
-		*
-		*		[
-		*			Ext::Array<Vertex>			:		GetGraphAllocationSize(_graph.size());
-		*												:		5 * GetQWORDAlignedSize(_graph.size() * sizeof(ID));
-		*												:		4 * GetQWordAlignedSizeForBits(_graph.size());
-		*		] * 5
-		*/
-		UInt32	bitSetLength = (UInt32)GetQWordAlignedSizeForBits(_graph.size());
-		Clique::ResourceManager	resourceManager((decltype(Vertex::Id))_graph.size(), (UInt32)(2 * 32 * sizeof(int) + bitSetLength * 3 + (3 * GetQWordAlignedSize(_graph.size() * sizeof(ID)) + 3 * bitSetLength) * Clique::FramesPerBlock * 2));
-		ReleaseMemoryToPool dtor(resourceManager.GraphMemoryPool, resourceManager.GraphMemoryPool.Allocate(GetGraphAllocationSize(_graph.size())));
+		std::string Solver::ExportCounters(CounterFormat _format, const char* _label) const
+		{
+			std::string text;
+			if (Resources != nullptr)
+				Resources->Counters.Export(_format, _label, text);
+			else
+			{
+				CounterSet counters(1, false);
+				counters.Export(_format, _label, text);
+			}
 
-		auto graph = CloneGraph(_graph, dtor.ptr());
-		AddSelfEdges(graph);
-		Graph::ComplementGraph(graph, graph);
+			return text;
+		}
 
-		auto colors = GetClusters(graph, _pSets, _vertexColor, _cliqueSize, 0, resourceManager);
+		std::string Solver::ReportProfile() const
+		{
+			return (Resources == nullptr) ? std::string() : Clique::ReportProfile(*Resources);
+		}
 
-		// if (_vertexColor != nullptr) assert(IsValidColoring(_graph, _vertexColor));
+		void Solver::SetProgressHandler(OnProgress _handler, void* _context, UInt32 _intervalMs)
+		{
+			ProgressHandler = _handler;
+			ProgressContext = _context;
+			ProgressInterval = _intervalMs;
+			if (Resources != nullptr)
+				Clique::SetProgressHandler(*Resources, _handler, _context, _intervalMs);
+		}
 
-		return colors;
+		void Solver::SetTraceStatistics(bool _traceStatistics)
+		{
+			TraceStatistics = _traceStatistics;
+			if (Resources != nullptr)
+				Resources->TraceStatistics = _traceStatistics;
+		}
 	}
 
 	bool ExtractPartition(ID& activeVertexCount, ID& cliqueVertexCount, ID& cliqueSize,
@@ -1423,6 +1998,106 @@ namespace Graph
 		Clique::ResourceManager& _resourceManager);
 
 
+	/*
+	*	Branch and bound on the rows of _graph restricted to _candidates (_qwords); no graph is copied.
+	*	_clique[0, _depth) : vertices chosen so far. A clique larger than _best is copied to _members.
+	*	Returns the size of the largest clique known (_best when none is larger).
+	*/
+	static decltype(Vertex::Id) ExpandMaskedClique(Ext::Array<Vertex> _graph, const UInt64* _candidates, size_t _qwords,
+		decltype(Vertex::Id) _depth, decltype(Vertex::Id) _best, bool _isExactSearch,
+		ID* _clique, ID* _members, Clique::ResourceManager& _resourceManager)
+	{
+		auto count = (decltype(Vertex::Id))PopCount((UInt64*)_candidates, _qwords);
+		if ((count == 0) || (_isExactSearch && (_depth > _best)))
+		{
+			if (_depth <= _best)
+				return _best;
+
+			for (decltype(Vertex::Id) i = 0; i < _depth; i++)
+				_members[i] = _clique[i];
+
+			return _depth;
+		}
+
+		if ((_depth + count) <= _best)
+			return _best;
+
+		ReleaseMemoryToPool dtor(_resourceManager.MemoryPool, _resourceManager.MemoryPool.Allocate(_qwords * sizeof(UInt64) * 2));
+		if (dtor.ptr() == nullptr)
+			throw "memory budget exceeded.";
+
+		auto p = (UInt64*)dtor.ptr();
+		auto next = p + _qwords;
+		auto best = _best;
+
+		CopyMemoryPack8(p, (void*)_candidates, _qwords * sizeof(UInt64));
+
+		for (size_t k = 0; (k < _qwords) && ((_depth + count) > best); k++)
+		{
+			while ((p[k] != 0) && ((_depth + count) > best))
+			{
+				unsigned long pos;
+				_BitScanForward64(&pos, p[k]);
+				_bittestandreset64((Int64*)&p[k], pos);
+				count--;
+
+				auto v = (decltype(Vertex::Id))((k << 6) + pos);
+				AandB(p, (UInt64*)_graph[v].Neighbours, next, _qwords);
+
+				_clique[_depth] = v;
+				best = ExpandMaskedClique(_graph, next, _qwords, _depth + 1, best, _isExactSearch, _clique, _members, _resourceManager);
+				if (_isExactSearch && (best > _best))
+					return best;
+			}
+		}
+
+		return best;
+	}
+
+	/*
+	*	Subgraph of TryFindClique (activeNeighbours of _graph) solved without a copy when the memory budget is reached.
+	*	The clique found is recorded the way the nested TryFindClique records it: partition sets of _cliqueMembers from
+	*	_cliqueMembersCount and, for MaximumClique, This.CliqueMembers.
+	*	_cliqueSize (in/out) and the result follow the nested call: for MaximumClique the next size to look for.
+	*/
+	static bool FindMaskedClique(Ext::Array<Vertex> _graph, ID *_originalVertexId, byte* _mask,
+		Ext::Unsafe::ArrayOfSet<Clique::ElementData, ID>& _cliqueMembers,
+		decltype(Vertex::Id) _cliqueMembersCount,
+		decltype(Vertex::Id)& _cliqueSize, Clique::FindOperation _op,
+		Clique::ResourceManager& _resourceManager)
+	{
+		auto isMaximumClique = (_op == Clique::FindOperation::MaximumClique);
+		auto best = (_cliqueSize > 0) ? (_cliqueSize - 1) : 0;
+		auto members = _resourceManager.lId3;
+		decltype(Vertex::Id) i;
+
+		CountEvent(_resourceManager.Counters, MaskedSubgraphs);
+
+		auto cliqueSize = ExpandMaskedClique(_graph, (UInt64*)_mask, GetQWordSizeForBits(_graph.size()), 0, best, !isMaximumClique, _resourceManager.lId2, members, _resourceManager);
+		if (cliqueSize == best)
+			return false;
+
+		for (i = 0; i < cliqueSize; i++)
+			_cliqueMembers.CreateTrivialSet(_cliqueMembersCount + i).SetValue(members[i], _originalVertexId[members[i]]);
+
+		if (!isMaximumClique)
+		{
+			_cliqueSize = cliqueSize;
+			return true;
+		}
+
+		if ((_cliqueMembersCount + cliqueSize) > _resourceManager.This.CliqueSize)
+		{
+			_resourceManager.This.CliqueSize = _cliqueMembersCount + cliqueSize;
+			for (i = 0; i < _resourceManager.This.CliqueSize; i++)
+				_resourceManager.This.CliqueMembers[i] = _cliqueMembers.GetValue(i, 0).OriginalVertexId;
+		}
+
+		_cliqueSize = cliqueSize + 1; // Lets look for the next larger clique.
+		return false;
+	}
+
+
 #define TryFindClique_Recursion1
 
 	// Top level invokation parameters
@@ -1449,15 +2124,31 @@ namespace Graph
 		decltype(Vertex::Id)	id, i, j, k, l, n;
 		Ext::BooleanError isCliqueExist;
 		Clique::TryFindCliqueCallFrame *frame;
+		void *graphMemory;
 
 		Ext::Array<Vertex> graph;
 		auto ticks = GetCurrentTick();
+#if (CliqueProfile)
+		UInt64 stageStart = 0;
+#endif
+		bool isDone;
+
+		// Loop body locals; declared here as the goto to ReturnTo enters the loop past any initialization.
+		decltype(Vertex::Id)	cliqueVertexCountAtStart, pivotVertexIdx, cliqueVertexCount2, subCliqueSize, subGraphSize;
+		decltype(Vertex::Id)	commonCount, activeNeighboursCount, commonCountMax, commonCountMaxId;
+		decltype(Vertex::Id)	*originalVertexId;
+		byte *targettedVertices;
+		bool isExist, skipTargettedVerticesForSubgraph;
 
 	Enter:
 
 		bitSetLength = (decltype(Vertex::Id))GetQWordAlignedSizeForBits(_graph.size());
 
-		activeVertexList = (byte*)_resourceManager.MemoryPool.Allocate(bitSetLength * 2 + GetQWordAlignedSize(_graph.size() * sizeof(ID)) * 2);
+		_resourceManager.CallFrame[_depth].scratchMark = _resourceManager.ScratchArena.Mark();
+		activeVertexList = (byte*)_resourceManager.ScratchArena.Allocate(bitSetLength * 2 + GetQWordAlignedSize(_graph.size() * sizeof(ID)) * 2);
+		if (activeVertexList == nullptr)
+			throw "memory budget exceeded.";
+
 		activeNeighbours = activeVertexList + bitSetLength;
 		vertexId = (decltype(Vertex::Id)*)(activeNeighbours + bitSetLength);
 		vertexEdgeCount = (decltype(Vertex::Id)*)((byte*)vertexId + GetQWordAlignedSize(_graph.size() * sizeof(ID)));
@@ -1472,7 +2163,15 @@ namespace Graph
 		frame->_targettedVertices = _targettedVertices;
 		frame->_targettedVerticesCount = _targettedVerticesCount;
 		frame->callCount++;
-		frame->startCallCount = _resourceManager.Calls++;
+		frame->startCallCount = _resourceManager.Counters.Get(Clique::Counter::Calls);
+		SetCounterDepth(_resourceManager.Counters, _depth);
+		_resourceManager.Counters.Add(Clique::Counter::Calls);
+		ProfileEnter(_resourceManager.Profile, _depth);
+		_resourceManager.CheckProgress(_depth);
+
+		// No clique is reported from here on, so the callers unwind through their remaining vertices at once.
+		if (_resourceManager.IsPastDeadline())
+			goto ReturnOnError;
 
 		if (s_ShouldSaveGraph && (_depth >= s_SaveGraphDepth))
 		{
@@ -1480,6 +2179,8 @@ namespace Graph
 			s_ShouldSaveGraph = false;
 		}
 
+		ProfileBegin(_resourceManager.Profile, _depth, stageStart);
+
 		// Sort vertices in DESC order based on vertex degree
 		for (i = 0, j = (ID)_graph.size(), k = 0; i < _graph.size(); i++)
 		{
@@ -1502,6 +2203,7 @@ namespace Graph
 
 		// start with all vertices as active.
 		SetNBits((UInt64*)activeVertexList, _graph.size());
+		ProfileEnd(_resourceManager.Profile, Order, _depth, stageStart);
 
 		cliqueSize = _cliqueSize;
 
@@ -1515,15 +2217,17 @@ namespace Graph
 				continue;
 			}
 
-			auto cliqueVertexCountAtStart = cliqueVertexCount;
+			cliqueVertexCountAtStart = cliqueVertexCount;
 
-			if (ExtractPartition(activeVertexCount, cliqueVertexCount, cliqueSize,
+			ProfileBegin(_resourceManager.Profile, _depth, stageStart);
+			isDone = ExtractPartition(activeVertexCount, cliqueVertexCount, cliqueSize,
 				vertexId, vertexEdgeCount, activeVertexList,
 				_graph, _originalVertexId, _cliqueMembers, _cliqueMembersCount,
-				_targettedVertices, _targettedVerticesCount, _resourceManager))
-			{
+				_targettedVertices, _targettedVerticesCount, _resourceManager);
+			ProfileEnd(_resourceManager.Profile, ExtractPartition, _depth, stageStart);
+
+			if (isDone)
 				goto ExitOutermostLoop;
-			}
 
 			if (activeVertexCount < cliqueSize)
 				break;
@@ -1553,6 +2257,8 @@ namespace Graph
 #pragma region Check whether clique is possible
 			if (activeVertexCount < (cliqueSize << 1))		// (activeVertexCount < (2 * cliqueSize))
 			{
+				ProfileBegin(_resourceManager.Profile, _depth, stageStart);
+
 				Int64 edgeTotal = 0, edgeTotal2 = 0;
 				for (i = 0; i < cliqueSize; i++)
 					edgeTotal += vertexEdgeCount[i];
@@ -1565,7 +2271,8 @@ namespace Graph
 				edgeTotal2 -= i * i;
 				if (edgeTotal < edgeTotal2)
 				{
-					_resourceManager.TwoNHits++;
+					CountEvent(_resourceManager.Counters, TwoNHits);
+					ProfileEnd(_resourceManager.Profile, Bound, _depth, stageStart);
 					break;
 				}
 				else if ((cliqueSize > 32) && (vertexEdgeCount[activeVertexCount - 1] > cliqueSize) &&
@@ -1574,29 +2281,45 @@ namespace Graph
 					// (cliqueSize > 32) : cost of CreateGraph() is acceptable.
 					// (vertexEdgeCount[activeVertexCount - 1] > cliqueSize) : All vertices have at least cliqueSize edges.
 					// (edgeTotal > edgeTotal2) : If equal then removing one vertices would be enough.
-					graph = CreateGraph(activeVertexCount, _resourceManager.AllocateGraphMemory(activeVertexCount));
-					ExtractGraph(_graph, graph, activeVertexList, _resourceManager.BitSet);
-					ComplementGraph(graph, graph);
+					frame->pushGraphMark = _resourceManager.GraphArena.Mark();
+					graphMemory = _resourceManager.AllocateGraphMemory(activeVertexCount, _depth);
+					if (graphMemory == nullptr)
+					{
+						// Memory budget reached : the bound is optional.
+						CountEvent(_resourceManager.Counters, ColorBoundSkips);
+						ProfileEnd(_resourceManager.Profile, Bound, _depth, stageStart);
+						goto SkipColorBound;
+					}
+
+					graph = CreateGraph(activeVertexCount, graphMemory, false);
+					ExtractComplementGraph(_graph, graph, activeVertexList, _resourceManager.BitSet);
+					ProfileEnd(_resourceManager.Profile, Bound, _depth, stageStart);
 
 					// GetClusters needs to be replaced with faster one.
 					auto colors = GetClusters(graph, nullptr, Ext::Array<Graph::ID>(nullptr, 0), 0, _depth + 1, _resourceManager);
-					_resourceManager.GraphMemoryPool.Free(graph.ptr());
+					_resourceManager.ReleaseGraphMemory(graph.ptr(), frame->pushGraphMark);
+					SetCounterDepth(_resourceManager.Counters, _depth);
 					if (colors < cliqueSize)
 					{
-						_resourceManager.TwoNColorHits++;
+						CountEvent(_resourceManager.Counters, TwoNColorHits);
 						break;
 					}
 
-					_resourceManager.Count11++;
+					CountEvent(_resourceManager.Counters, TwoNColorMisses);
 				}
+				else
+					ProfileEnd(_resourceManager.Profile, Bound, _depth, stageStart);
 			}
+		SkipColorBound:
 #pragma endregion
 
-			auto pivotVertexIdx = (((activeVertexCount - vertexEdgeCount[0]) == 2) && (activeVertexCount > 32)) ? (decltype(Vertex::Id))0 : (activeVertexCount - 1);
-			auto cliqueVertexCount2 = (decltype(cliqueVertexCount))0;
-			auto subCliqueSize = cliqueSize;
+			ProfileBegin(_resourceManager.Profile, _depth, stageStart);
+
+			pivotVertexIdx = (((activeVertexCount - vertexEdgeCount[0]) == 2) && (activeVertexCount > 32)) ? (decltype(Vertex::Id))0 : (activeVertexCount - 1);
+			cliqueVertexCount2 = 0;
+			subCliqueSize = cliqueSize;
 			id = vertexId[pivotVertexIdx];
-			auto subGraphSize = (decltype(Vertex::Id))PopCountAandB_Set((UInt64*)activeVertexList, (UInt64*)_graph[id].Neighbours, (UInt64*)activeNeighbours, (bitSetLength >> 3));
+			subGraphSize = (decltype(Vertex::Id))PopCountAandB_Set((UInt64*)activeVertexList, (UInt64*)_graph[id].Neighbours, (UInt64*)activeNeighbours, (bitSetLength >> 3));
 			decltype(Vertex::Id) id2;
 
 			ids = _resourceManager.lId;
@@ -1643,7 +2366,7 @@ namespace Graph
 				}
 			}
 
-			auto isExist = (subCliqueSize <= subGraphSize);
+			isExist = (subCliqueSize <= subGraphSize);
 			if ((cliqueVertexCount2 > 0) && isExist)
 			{
 				id = vertexId[pivotVertexIdx];
@@ -1678,7 +2401,7 @@ namespace Graph
 					_cliqueMembers.CreateTrivialSet(j).SetValue(ids[i], _originalVertexId[ids[i]]);
 			}
 
-			auto skipTargettedVerticesForSubgraph = true;
+			skipTargettedVerticesForSubgraph = true;
 			if ((_targettedVerticesCount > 0) && isExist && (0 < subGraphSize))
 			{
 				j = 0;
@@ -1700,20 +2423,24 @@ namespace Graph
 			}
 
 			cliqueVertexCount2 += cliqueVertexCount;
+			ProfileEnd(_resourceManager.Profile, Neighbourhood, _depth, stageStart);
 
-			_resourceManager.SubgraphHits++;
+			CountEvent(_resourceManager.Counters, SubgraphHits);
 
 			if ((0 < subGraphSize) && (subCliqueSize <= subGraphSize) && ((0 < subCliqueSize) || (_op != Clique::FindOperation::ExactSearch)))
 			{
 				isExist = false;
 				id = vertexId[pivotVertexIdx];
 
-				decltype(Vertex::Id) commonCount = 0, activeNeighboursCount = subGraphSize + (cliqueVertexCount2 - cliqueVertexCount);
-				decltype(Vertex::Id) commonCountMax = 0, commonCountMaxId = INVALID_ID;
+				commonCount = 0;
+				activeNeighboursCount = subGraphSize + (cliqueVertexCount2 - cliqueVertexCount);
+				commonCountMax = 0;
+				commonCountMaxId = INVALID_ID;
 
 				if ((cliqueVertexCountAtStart < cliqueVertexCount) || ((subGraphSize + (cliqueVertexCount2 - cliqueVertexCount)) < vertexEdgeCount[pivotVertexIdx]))
 				{
-					_resourceManager.BtmUpCheck++;
+					CountEvent(_resourceManager.Counters, BtmUpCheck);
+					ProfileBegin(_resourceManager.Profile, _depth, stageStart);
 
 					pActiveNeighbours = _resourceManager.BitSet;
 					CopyMemoryPack8(pActiveNeighbours, activeNeighbours, bitSetLength);
@@ -1742,7 +2469,7 @@ namespace Graph
 								if (n < (cliqueVertexCount - l))
 									commonCount = 0;
 
-								_resourceManager.BtmUpCheck2++;
+								CountEvent(_resourceManager.Counters, BtmUpCheck2);
 							}
 
 							if (commonCount > commonCountMax)
@@ -1755,24 +2482,37 @@ namespace Graph
 							l--;
 					}
 
+					ProfileEnd(_resourceManager.Profile, BottomUpCheck, _depth, stageStart);
 					if (commonCount == activeVertexCount) // no more cliques in this _graph.
 						break;
 				}
 
-				if (commonCount < activeNeighboursCount)
-				{
-					auto targettedVertices = (byte*)_resourceManager.MemoryPool.Allocate(GetQWordAlignedSize(subGraphSize * sizeof(ID)) + GetQWordAlignedSizeForBits(subGraphSize));
-					auto originalVertexId = (decltype(Vertex::Id)*)(targettedVertices + GetQWordAlignedSizeForBits(subGraphSize));
+				frame->pushScratchMark = _resourceManager.ScratchArena.Mark();
+				frame->pushGraphMark = _resourceManager.GraphArena.Mark();
 
-					graph = CreateGraph(subGraphSize, _resourceManager.AllocateGraphMemory(subGraphSize));
-					ExtractGraph(_graph, graph, activeNeighbours, _resourceManager.BitSet);
+				if ((commonCount < activeNeighboursCount) && ((graphMemory = _resourceManager.AllocateGraphMemory(subGraphSize, _depth)) == nullptr))
+				{
+					// Memory budget reached : the subgraph is searched through activeNeighbours instead of a copy.
+					isExist = FindMaskedClique(_graph, _originalVertexId, activeNeighbours, _cliqueMembers, _cliqueMembersCount + cliqueVertexCount2, subCliqueSize, _op, _resourceManager);
+				}
+				else if (commonCount < activeNeighboursCount)
+				{
+					ProfileBegin(_resourceManager.Profile, _depth, stageStart);
+					targettedVertices = (byte*)_resourceManager.ScratchArena.Allocate(GetQWordAlignedSize(subGraphSize * sizeof(ID)) + GetQWordAlignedSizeForBits(subGraphSize));
+					originalVertexId = (decltype(Vertex::Id)*)(targettedVertices + GetQWordAlignedSizeForBits(subGraphSize));
 
-					for (j = 0, i = 0; i < _graph.size(); i++)
+					if (targettedVertices == nullptr)
 					{
-						if (BitTest(activeNeighbours, i))
-							originalVertexId[j++] = _originalVertexId[i];
+						_resourceManager.ReleaseGraphMemory(graphMemory, frame->pushGraphMark);
+						throw "memory budget exceeded.";
 					}
 
+					graph = CreateGraph(subGraphSize, graphMemory);
+					ExtractGraph(_graph, graph, activeNeighbours, _resourceManager.BitSet);
+
+					j = 0;
+					ForEachBit((UInt64*)activeNeighbours, bitSetLength / sizeof(UInt64), [&](ID k) { originalVertexId[j++] = _originalVertexId[k]; });
+
 					decltype(Vertex::Id) targettedVerticesCount;
 					if (skipTargettedVerticesForSubgraph || ((_targettedVerticesCount == 0) && (commonCountMaxId == INVALID_ID)))
 					{
@@ -1796,6 +2536,8 @@ namespace Graph
 					frame->subGraphSize = subGraphSize;
 					frame->cliqueVertexCount2 = cliqueVertexCount2;
 					frame->isCliqueExist = isCliqueExist;
+					ProfileEnd(_resourceManager.Profile, SubgraphExtraction, _depth, stageStart);
+					ProfilePush(_resourceManager.Profile, _depth, subGraphSize);
 
 					// Done at the top of the function on enter.
 					//frame->_targettedVertices = _targettedVertices;
@@ -1828,6 +2570,7 @@ namespace Graph
 #pragma region Pop CallFrame
 					ReturnTo :
 								frame = &_resourceManager.CallFrame[--_depth];
+								SetCounterDepth(_resourceManager.Counters, _depth);
 
 								isExist = (isCliqueExist == Ext::BooleanError::True);
 								graph = _graph;
@@ -1856,8 +2599,9 @@ namespace Graph
 								pivotVertexIdx = frame->pivotVertexIdx;
 #pragma endregion
 #endif
-								_resourceManager.MemoryPool.Free(targettedVertices);
-								_resourceManager.GraphMemoryPool.Free(graph.ptr());
+								// A single pointer reset each, for the nested call's scratch and subgraph.
+								_resourceManager.ScratchArena.Release(frame->pushScratchMark);
+								_resourceManager.ReleaseGraphMemory(graph.ptr(), frame->pushGraphMark);
 
 								if (isCliqueExist == Ext::BooleanError::Error)
 									goto ReturnOnError;
@@ -1866,22 +2610,29 @@ namespace Graph
 								if (_graph.ptr() == nullptr)
 								{
 									// assert(_depth > _resourceManager.This.ZeroReferenceDepth); // The input _graph at depth 0 should never be touched.
-									frame = &_resourceManager.CallFrame[0];
+									graphMemory = _resourceManager.AllocateGraphMemory(_graph.size(), _depth);
+									if (graphMemory == nullptr)
+										throw "memory budget exceeded.";
+
+									// _originalVertexId refers to the graph of the top level (ZeroReferenceDepth) invocation.
+									frame = &_resourceManager.CallFrame[_resourceManager.This.ZeroReferenceDepth];
 									pActiveNeighbours = _resourceManager.BitSet2;
 									ZeroMemoryPack8(pActiveNeighbours, frame->bitSetLength);
 									for (i = 0; i < _graph.size(); i++)
 										BitSet(pActiveNeighbours, _originalVertexId[i]);
 
-									_graph = CreateGraph((decltype(id))_graph.size(), _resourceManager.GraphMemoryPool.Allocate(GetGraphAllocationSize(_graph.size())));
+									_graph = CreateGraph((decltype(id))_graph.size(), graphMemory);
 									ExtractGraph(frame->_graph, _graph, pActiveNeighbours, _resourceManager.BitSet);
 
+									frame = &_resourceManager.CallFrame[_depth];
+									frame->_graph = _graph;
 									_resourceManager.This.TopGraphForMemoryReclaim = _depth;
 								}
 				}
 				else
 				{
 					// ToDo: Check whether this vertex forms clique or not.
-					_resourceManager.BtmUpHits2++;
+					CountEvent(_resourceManager.Counters, BtmUpHits2);
 				}
 			}
 
@@ -1915,24 +2666,29 @@ namespace Graph
 					goto Return; // isCliqueExist can't be set to false after this since it is true now. Note: Refer before 'Return:' label. 
 			}
 
-			if (RemoveVertexAndEquivalent(pivotVertexIdx, isExist,
+			ProfileBegin(_resourceManager.Profile, _depth, stageStart);
+			isDone = RemoveVertexAndEquivalent(pivotVertexIdx, isExist,
 				activeVertexCount, cliqueVertexCount, cliqueSize,
 				vertexId, vertexEdgeCount, activeVertexList,
 				activeNeighbours, _graph,
-				_targettedVertices, _targettedVerticesCount, _resourceManager))
-			{
+				_targettedVertices, _targettedVerticesCount, _resourceManager);
+			ProfileEnd(_resourceManager.Profile, RemoveVertexAndEquivalent, _depth, stageStart);
+
+			if (isDone)
 				goto ExitOutermostLoop;
-			}
 
 			if (_resourceManager.This.PrintStatistics && (_depth == _resourceManager.This.ZeroReferenceDepth))
 			{
 				char sz[512];
-				sprintf_s(sz, sizeof(sz), "%15d %15d %15d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d %15I64d\n", (int)graph.size(), cliqueSize, _cliqueSize, GetCurrentTick() - ticks, _resourceManager.Calls, _resourceManager.PartitionExtr, _resourceManager.TwoNHits, _resourceManager.TwoNColorHits, _resourceManager.SubgraphHits, _resourceManager.BtmUpHits, _resourceManager.BtmUpHits2, _resourceManager.BtmUpCheck, _resourceManager.BtmUpCheck2, _resourceManager.Count9, _resourceManager.Count11, _resourceManager.Count12, _resourceManager.Count13, _resourceManager.Count14);
+				auto length = sprintf_s(sz, sizeof(sz), "%15d %15d %15d %15lld", (int)graph.size(), cliqueSize, _cliqueSize, GetCurrentTick() - ticks);
+				length += _resourceManager.Counters.FormatValues(sz + length, sizeof(sz) - length - 1);
+				sz[length] = '\n';
+				sz[length + 1] = 0;
 				TraceMessage(sz);
 
 				for (i = 0; (_resourceManager.CallFrame[i].callCount > 0); i++)
 				{
-					sprintf_s(sz, sizeof(sz), "%15d Calls:%15I64d\n", (int)i + 1, _resourceManager.CallFrame[i].callCount);
+					sprintf_s(sz, sizeof(sz), "%15d Calls:%15lld\n", (int)i + 1, _resourceManager.CallFrame[i].callCount);
 					TraceMessage(sz);
 				}
 			}
@@ -1954,7 +2710,8 @@ namespace Graph
 			_cliqueSize = (cliqueVertexCount + cliqueSize);
 
 	ReturnOnError:
-		_resourceManager.MemoryPool.Free(activeVertexList);
+		_resourceManager.ScratchArena.Release(_resourceManager.CallFrame[_depth].scratchMark);
+		ProfileLeave(_resourceManager.Profile, _depth);
 
 #if (!defined(TryFindClique_Recursion))
 		if (_depth > _resourceManager.This.ZeroReferenceDepth)
@@ -2030,7 +2787,7 @@ namespace Graph
 			if ((m == activeVertexCount) || (vertexEdgeCount[m] < vertexEdgeCount[0]))
 				goto LoopExit;
 
-			_resourceManager.PartitionExtr++;
+			CountEvent(_resourceManager.Counters, PartitionExtr);
 
 			id = ids[0];
 			pActiveNeighbours = _graph[id].Neighbours;
@@ -2069,7 +2826,7 @@ namespace Graph
 				// (id >= n) : all ConnectedToAll vertices in this partition are targetted vertices.
 				if ((_targettedVerticesCount == 0) && (id < n))
 				{
-					_resourceManager.Count9++;
+					CountEvent(_resourceManager.Counters, TargetsCovered);
 					return true; // goto ExitOutermostLoop;	// done processing this _graph
 				}
 				else if ((_targettedVerticesCount > 0) && (id >= n))
@@ -2125,7 +2882,7 @@ namespace Graph
 
 		if ((_targettedVerticesCount > 0) && BitTest(_targettedVertices, vertexId[pivotVertexIdx]) && (--_targettedVerticesCount == 0))
 		{
-			_resourceManager.Count9++;
+			CountEvent(_resourceManager.Counters, TargetsCovered);
 			return true;	// goto ExitOutermostLoop;	// done processing this _graph
 		}
 
@@ -2174,17 +2931,17 @@ namespace Graph
 					{
 						queue.push(id2);
 						BitSet(queuedVertices, id2);
-						_resourceManager.BtmUpHits++;
+						CountEvent(_resourceManager.Counters, BtmUpHits);
 
 						if ((_targettedVerticesCount > 0) && BitTest(_targettedVertices, id2) && (--_targettedVerticesCount == 0))
 						{
-							_resourceManager.Count9++;
+							CountEvent(_resourceManager.Counters, TargetsCovered);
 							return true;	// goto ExitOutermostLoop;	// done processing this _graph
 						}
 					}
 					else if (checkPartition)
 					{
-						_resourceManager.Count12++;
+						CountEvent(_resourceManager.Counters, EquivalenceMisses);
 					}
 				}
 
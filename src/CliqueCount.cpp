@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "GraphUtility.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Graph
+{
+	namespace Clique
+	{
+		/*
+		*	k-clique counting over the degeneracy oriented graph : each clique is counted once from its
+		*	lowest positioned vertex. Out neighbours of position i are all greater than i, so the bit sets
+		*	are only intersected from the word holding i + 1 onwards.
+		*
+		*	_candidates	:	common out neighbours of the vertices chosen so far.
+		*	_remaining	:	vertices still to be chosen from _candidates.
+		*	_scratch		:	_remaining - 1 bit sets of _qwords each.
+		*	_count		:	accumulates with carry, as the cliques of a single root may exceed 64 bits.
+		*/
+		static void CountCliques(Ext::Array<Vertex> _graph, UInt64* _candidates, size_t _first, size_t _qwords, decltype(Vertex::Id) _remaining, UInt64* _scratch, CliqueCount& _count)
+		{
+			if (_remaining == 1)
+			{
+				_count.Add(PopCount(_candidates + _first, _qwords - _first));
+				return;
+			}
+
+			for (size_t k = _first; k < _qwords; k++)
+			{
+				UInt64 bits = _candidates[k];
+				while (bits != 0)
+				{
+					unsigned long pos;
+					_BitScanForward64(&pos, bits);
+					_bittestandreset64((Int64*)&bits, pos);
+
+					size_t w = (k << 6) + pos;
+					size_t first = (w + 1) >> 6;
+					auto neighbours = (UInt64*)_graph[w].Neighbours;
+
+					if (_remaining == 2)
+					{
+						// last level : count without materializing the intersection.
+						_count.Add(PopCountAandB(_candidates + first, neighbours + first, _qwords - first));
+						continue;
+					}
+
+					if (_graph[w].Count < _remaining - 1)
+						continue;
+
+					if (PopCountAandB_Set(_candidates + first, neighbours + first, _scratch + first, _qwords - first) < _remaining - 1)
+						continue;
+
+					CountCliques(_graph, _scratch, first, _qwords, _remaining - 1, _scratch + _qwords, _count);
+				}
+			}
+		}
+
+		static void CountRootedCliques(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _root, decltype(Vertex::Id) _k, UInt64* _scratch, CliqueCount& _count)
+		{
+			if (_graph[_root].Count < _k - 1)
+				return;
+
+			size_t qwords = GetQWordSizeForBits(_graph.size());
+			CountCliques(_graph, (UInt64*)_graph[_root].Neighbours, (_root + 1) >> 6, qwords, _k - 1, _scratch, _count);
+		}
+
+		// splitmix64
+		static UInt64 NextRandom(UInt64& _state)
+		{
+			UInt64 z = (_state += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+	}
+
+	Clique::CliqueCount CountCliques(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _k, UInt32 _threads)
+	{
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
+
+		Clique::CliqueCount result;
+		auto n = (decltype(Vertex::Id))_graph.size();
+
+		if ((_k == 0) || (_k > n))
+			return result;
+
+		std::vector<ID> order(n);
+		GetDegeneracyOrder(_graph, Ext::Array<ID>(order.data(), n));
+
+		auto graph = CreateOrientedGraph(_graph, Ext::Array<ID>(order.data(), n));
+		GraphDtor dtor(graph);
+
+		if (_k == 1)
+		{
+			result.Add(n);
+			return result;
+		}
+
+		// Heaviest roots first for load balance.
+		std::vector<ID> roots(n);
+		for (decltype(Vertex::Id) i = 0; i < n; i++)
+			roots[i] = i;
+
+		std::stable_sort(roots.begin(), roots.end(), [&](ID a, ID b) { return graph[a].Count > graph[b].Count; });
+
+		auto threads = Parallel::GetThreadCount(_threads);
+		size_t qwords = GetQWordSizeForBits(n);
+		std::vector<Clique::CliqueCount> counts(threads);
+		std::vector<std::vector<UInt64>> scratch(threads);
+
+		Parallel::For(n, threads, [&](UInt32 _threadIndex, size_t _item)
+		{
+			if (scratch[_threadIndex].size() == 0)
+				scratch[_threadIndex].resize(qwords * _k);
+
+			Clique::CountRootedCliques(graph, roots[_item], _k, scratch[_threadIndex].data(), counts[_threadIndex]);
+		});
+
+		for (auto& count : counts)
+			result.Add(count);
+
+		return result;
+	}
+
+	double EstimateCliques(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _k, UInt32 _samples, UInt64 _seed, UInt32 _threads)
+	{
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
+
+		auto n = (decltype(Vertex::Id))_graph.size();
+		if ((_k == 0) || (_k > n) || (_samples == 0))
+			return 0;
+
+		std::vector<ID> order(n), roots(_samples);
+		GetDegeneracyOrder(_graph, Ext::Array<ID>(order.data(), n));
+
+		auto graph = CreateOrientedGraph(_graph, Ext::Array<ID>(order.data(), n));
+		GraphDtor dtor(graph);
+
+		//	Σ count(root) over all roots is the exact count; uniform roots drawn with replacement give an unbiased estimate.
+		UInt64 state = _seed;
+		for (UInt32 i = 0; i < _samples; i++)
+			roots[i] = (ID)(Clique::NextRandom(state) % n);
+
+		auto threads = Parallel::GetThreadCount(_threads);
+		size_t qwords = GetQWordSizeForBits(n);
+		std::vector<Clique::CliqueCount> counts(threads);
+		std::vector<std::vector<UInt64>> scratch(threads);
+
+		Parallel::For(_samples, threads, [&](UInt32 _threadIndex, size_t _item)
+		{
+			if (scratch[_threadIndex].size() == 0)
+				scratch[_threadIndex].resize(qwords * _k);
+
+			if (_k == 1)
+				counts[_threadIndex].Add(1);
+			else
+				Clique::CountRootedCliques(graph, roots[_item], _k, scratch[_threadIndex].data(), counts[_threadIndex]);
+		});
+
+		Clique::CliqueCount total;
+		for (auto& count : counts)
+			total.Add(count);
+
+		return total.ToDouble() * n / _samples;
+	}
+}
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "GraphUtility.h"
+#include "Parallel.h"
+
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Graph
+{
+	//	xorshift64*; tie breaks and tabu tenures of the tabu search.
+	struct ColoringRandom
+	{
+		UInt64 State;
+
+		explicit ColoringRandom(UInt64 _seed) : State(_seed) {}
+
+		UInt32 Next(UInt32 _range)
+		{
+			State ^= State >> 12;
+			State ^= State << 25;
+			State ^= State >> 27;
+			return (UInt32)(((State * 0x2545F4914F6CDD1DULL) >> 32) % _range);
+		}
+	};
+
+	/*
+	*	DSATUR : the next vertex is the uncolored one seeing the most distinct colors (ties : most uncolored neighbours)
+	*	and takes the smallest color none of its neighbours has. A bit set per color holds the vertices adjacent to
+	*	that color, so the colors a vertex sees are bit tests and the saturation of its neighbours rises for the bits
+	*	of its row that are new to the bit set of its color. O(n^2 + n * colors / 64) for the rows read.
+	*/
+	static decltype(Vertex::Id) ColorDSatur(Ext::Array<Vertex> _graph, ID* _color)
+	{
+		auto n = (decltype(Vertex::Id))_graph.size();
+		size_t qwords = GetQWordSizeForBits(n);
+		std::vector<ID> saturation(n, 0), degree(n);
+		std::vector<UInt64> adjacent;		// qwords per color; row c - 1 : vertices adjacent to color c.
+		decltype(Vertex::Id) v, colors = 0;
+
+		for (v = 0; v < n; v++)
+		{
+			_color[v] = 0;
+			degree[v] = _graph[v].Count - (BitTest(_graph[v].Neighbours, v) ? 1 : 0);
+		}
+
+		for (decltype(Vertex::Id) step = 0; step < n; step++)
+		{
+			v = INVALID_ID;
+			for (decltype(Vertex::Id) u = 0; u < n; u++)
+			{
+				if ((_color[u] == 0) && ((v == INVALID_ID) || (saturation[u] > saturation[v]) || ((saturation[u] == saturation[v]) && (degree[u] > degree[v]))))
+					v = u;
+			}
+
+			decltype(Vertex::Id) c = 1;
+			while ((c <= colors) && BitTest((byte*)&adjacent[(c - 1) * qwords], v))
+				c++;
+
+			if (c > colors)
+			{
+				colors++;
+				adjacent.resize(colors * qwords, 0);
+			}
+
+			_color[v] = c;
+
+			auto row = (UInt64*)_graph[v].Neighbours;
+			auto seen = &adjacent[(c - 1) * qwords];
+			for (size_t w = 0; w < qwords; w++)
+			{
+				UInt64 fresh = row[w] & ~seen[w];
+				seen[w] |= row[w];
+
+				for (UInt64 bits = LoadBits64(&fresh); bits != 0; bits = ResetLowestBit64(bits))
+				{
+					auto u = (ID)(w << 6) + LowestBit64(bits);
+					if (_color[u] == 0)
+						saturation[u]++;
+				}
+			}
+
+			ForEachBit(row, qwords, [&](ID u)
+			{
+				if (_color[u] == 0)
+					degree[u]--;
+			});
+		}
+
+		return colors;
+	}
+
+	/*
+	*	Recursive largest first (Leighton) : builds one color class at a time out of the uncolored vertices U. The
+	*	class starts with the vertex of most neighbours in U; then, while candidates W (in U, not adjacent to the
+	*	class) remain, takes the one with the most neighbours in X (in U, adjacent to the class), ties broken by
+	*	the fewest neighbours in W. Each pick is a scan of W with PopCountAandB over the rows.
+	*/
+	static decltype(Vertex::Id) ColorRecursiveLargestFirst(Ext::Array<Vertex> _graph, ID* _color)
+	{
+		auto n = (decltype(Vertex::Id))_graph.size();
+		size_t qwords = GetQWordSizeForBits(n);
+		std::vector<UInt64> bitSets(3 * qwords);
+		UInt64 *uncolored = bitSets.data(), *candidates = uncolored + qwords, *adjacent = candidates + qwords;
+		decltype(Vertex::Id) remaining = n, colors = 0;
+
+		SetNBits(uncolored, n);
+		for (decltype(Vertex::Id) v = 0; v < n; v++)
+			_color[v] = 0;
+
+		while (remaining > 0)
+		{
+			colors++;
+			for (size_t w = 0; w < qwords; w++)
+			{
+				candidates[w] = uncolored[w];
+				adjacent[w] = 0;
+			}
+
+			ID v = INVALID_ID;
+			size_t best = 0;
+			ForEachBit(candidates, qwords, [&](ID u)
+			{
+				auto row = _graph[u].Neighbours;
+				size_t degree = PopCountAandB((UInt64*)row, uncolored, qwords) - (BitTest(row, u) ? 1 : 0);
+				if ((v == INVALID_ID) || (degree > best))
+				{
+					v = u;
+					best = degree;
+				}
+			});
+
+			while (v != INVALID_ID)
+			{
+				_color[v] = colors;
+				remaining--;
+				BitReset((byte*)uncolored, v);
+				BitReset((byte*)candidates, v);
+
+				auto row = (UInt64*)_graph[v].Neighbours;
+				for (size_t w = 0; w < qwords; w++)
+				{
+					UInt64 neighbours = row[w] & candidates[w];
+					adjacent[w] |= neighbours;
+					candidates[w] &= ~neighbours;
+				}
+
+				v = INVALID_ID;
+				size_t bestAdjacent = 0, bestCandidates = 0;
+				ForEachBit(candidates, qwords, [&](ID u)
+				{
+					auto row = (UInt64*)_graph[u].Neighbours;
+					size_t toAdjacent = PopCountAandB(row, adjacent, qwords);
+					if ((v != INVALID_ID) && (toAdjacent < bestAdjacent))
+						return;
+
+					size_t toCandidates = PopCountAandB(row, candidates, qwords) - (BitTest((byte*)row, u) ? 1 : 0);
+					if ((v == INVALID_ID) || (toAdjacent > bestAdjacent) || (toCandidates < bestCandidates))
+					{
+						v = u;
+						bestAdjacent = toAdjacent;
+						bestCandidates = toCandidates;
+					}
+				});
+			}
+		}
+
+		return colors;
+	}
+
+	//	splitmix64 of (_seed, _vertex); the Jones-Plassmann priorities depend on nothing else.
+	static UInt64 GetColoringPriority(UInt64 _seed, ID _vertex)
+	{
+		UInt64 z = _seed + 0x9E3779B97F4A7C15ULL * ((UInt64)_vertex + 1);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	/*
+	*	Jones-Plassmann : every vertex gets a random priority (GetColoringPriority, ties by id) and is colored, with
+	*	the smallest color its neighbours of higher priority do not have, once all of them are colored. waiting[v]
+	*	counts those still uncolored; a round colors the frontier (a bit set of the vertices whose count reached
+	*	zero, an independent set) and the vertex that colors the last of a neighbour's predecessors adds it to the
+	*	next frontier. Threads take chunks of frontier words. A color depends only on the priorities, so the
+	*	coloring is the same for a _seed whatever the thread count or the schedule.
+	*/
+	static decltype(Vertex::Id) ColorJonesPlassmann(Ext::Array<Vertex> _graph, ID* _color, UInt32 _threads, UInt64 _seed)
+	{
+		const size_t ChunkWords = 16;				// 1024 vertices a work item.
+		const size_t ParallelFrontier = 1024;		// smaller frontiers are colored on the calling thread.
+
+		auto n = (decltype(Vertex::Id))_graph.size();
+		size_t qwords = GetQWordSizeForBits(n), chunks = (qwords + ChunkWords - 1) / ChunkWords;
+		std::vector<UInt64> priority(n);
+		std::unique_ptr<std::atomic<ID>[]> waiting(new std::atomic<ID>[n + 1]);
+		std::unique_ptr<std::atomic<UInt64>[]> frontiers(new std::atomic<UInt64>[2 * qwords + 1]);
+		decltype(Vertex::Id) v, maxDegree = 0;
+
+		for (v = 0; v < n; v++)
+		{
+			_color[v] = 0;
+			priority[v] = GetColoringPriority(_seed, v);
+			if (_graph[v].Count > maxDegree)
+				maxDegree = _graph[v].Count;
+		}
+
+		for (size_t w = 0; w < 2 * qwords; w++)
+			frontiers[w] = 0;
+
+		auto isBefore = [&](ID _u, ID _v) { return (priority[_u] > priority[_v]) || ((priority[_u] == priority[_v]) && (_u > _v)); };
+
+		//	The frontier word bit of _u, in the byte order of the rows.
+		auto frontierBit = [](ID _u) { UInt64 bit = 1ULL << (_u & 63); return LoadBits64(&bit); };
+
+		auto current = frontiers.get(), next = current + qwords;
+		std::atomic<size_t> frontierCount(0);
+		auto threads = Parallel::GetThreadCount(_threads);
+
+		Parallel::For(chunks, threads, [&](UInt32, size_t _chunk)
+		{
+			size_t found = 0;
+			for (ID u = (ID)(_chunk * ChunkWords * 64); (u < n) && (u < (ID)((_chunk + 1) * ChunkWords * 64)); u++)
+			{
+				ID count = 0;
+				ForEachBit((UInt64*)_graph[u].Neighbours, qwords, [&](ID t)
+				{
+					if ((t != u) && isBefore(t, u))
+						count++;
+				});
+
+				waiting[u] = count;
+				if (count == 0)
+				{
+					current[u >> 6].fetch_or(frontierBit(u), std::memory_order_relaxed);
+					found++;
+				}
+			}
+
+			frontierCount += found;
+		});
+
+		//	Per thread; mark[c] == v : color c is taken by a neighbour of v.
+		std::vector<std::vector<ID>> marks(threads, std::vector<ID>(maxDegree + 2, INVALID_ID));
+		std::atomic<ID> colors(0);
+
+		while (frontierCount > 0)
+		{
+			auto roundThreads = (frontierCount < ParallelFrontier) ? 1 : threads;
+			frontierCount = 0;
+
+			Parallel::For(chunks, roundThreads, [&](UInt32 _threadIndex, size_t _chunk)
+			{
+				auto& mark = marks[_threadIndex];
+				size_t found = 0;
+				ID maxColor = 0;
+
+				for (size_t w = _chunk * ChunkWords; (w < qwords) && (w < (_chunk + 1) * ChunkWords); w++)
+				{
+					UInt64 word = current[w].exchange(0, std::memory_order_relaxed);
+					for (UInt64 bits = LoadBits64(&word); bits != 0; bits = ResetLowestBit64(bits))
+					{
+						auto u = (ID)(w << 6) + LowestBit64(bits);
+						auto row = (UInt64*)_graph[u].Neighbours;
+
+						ForEachBit(row, qwords, [&](ID t)
+						{
+							if ((t != u) && isBefore(t, u))
+								mark[_color[t]] = u;
+						});
+
+						ID c = 1;
+						while (mark[c] == u)
+							c++;
+
+						_color[u] = c;
+						if (c > maxColor)
+							maxColor = c;
+
+						ForEachBit(row, qwords, [&](ID t)
+						{
+							if ((t != u) && isBefore(u, t) && (--waiting[t] == 0))
+							{
+								next[t >> 6].fetch_or(frontierBit(t), std::memory_order_relaxed);
+								found++;
+							}
+						});
+					}
+				}
+
+				frontierCount += found;
+				for (ID c = colors; (c < maxColor) && !colors.compare_exchange_weak(c, maxColor); );
+			});
+
+			std::swap(current, next);
+		}
+
+		return colors;
+	}
+
+	/*
+	*	Tabu search (TabuCol, Hertz and de Werra) : takes a _colors coloring to _colors - 1 colors by recoloring the
+	*	vertices of the last color to their least conflicting color and then moving conflicting vertices, one at a
+	*	time, to the color of least conflicts not made tabu by a recent move. Repeats for as long as an attempt ends
+	*	without conflicts within _iterations moves. conflicts[v * k + c] counts the neighbours of v of color c + 1.
+	*	_pDeadline : the attempt under way is abandoned at that time (the clock is read once in 256 moves).
+	*/
+	static decltype(Vertex::Id) ImproveColoringTabu(Ext::Array<Vertex> _graph, ID* _color, decltype(Vertex::Id) _colors, UInt32 _iterations,
+		const std::chrono::steady_clock::time_point* _pDeadline)
+	{
+		auto n = (decltype(Vertex::Id))_graph.size();
+		size_t qwords = GetQWordSizeForBits(n);
+		std::vector<ID> trial(n), conflicts;
+		std::vector<UInt32> tabu;
+		ColoringRandom random(0x9E3779B97F4A7C15ULL);
+		bool isTimedOut = false;
+
+		while ((_colors > 1) && !isTimedOut)
+		{
+			auto k = _colors - 1;
+			conflicts.assign((size_t)n * k, 0);
+			tabu.assign((size_t)n * k, 0);
+
+			for (decltype(Vertex::Id) v = 0; v < n; v++)
+				trial[v] = (_color[v] <= k) ? (_color[v] - 1) : INVALID_ID;
+
+			for (decltype(Vertex::Id) v = 0; v < n; v++)
+			{
+				ForEachBit((UInt64*)_graph[v].Neighbours, qwords, [&](ID u)
+				{
+					if ((u != v) && (trial[u] != INVALID_ID))
+						conflicts[(size_t)v * k + trial[u]]++;
+				});
+			}
+
+			for (decltype(Vertex::Id) v = 0; v < n; v++)
+			{
+				if (trial[v] != INVALID_ID)
+					continue;
+
+				ID c, best = 0;
+				for (c = 1; c < k; c++)
+					if (conflicts[(size_t)v * k + c] < conflicts[(size_t)v * k + best])
+						best = c;
+
+				trial[v] = best;
+				ForEachBit((UInt64*)_graph[v].Neighbours, qwords, [&](ID u)
+				{
+					if (u != v)
+						conflicts[(size_t)u * k + best]++;
+				});
+			}
+
+			size_t conflictCount = 0;
+			for (decltype(Vertex::Id) v = 0; v < n; v++)
+				conflictCount += conflicts[(size_t)v * k + trial[v]];
+			conflictCount /= 2;
+
+			size_t bestCount = conflictCount;
+			for (UInt32 iteration = 1; (iteration <= _iterations) && (conflictCount > 0); iteration++)
+			{
+				if ((_pDeadline != nullptr) && ((iteration & 0xFF) == 0) && (std::chrono::steady_clock::now() >= *_pDeadline))
+				{
+					isTimedOut = true;
+					break;
+				}
+
+				ID moveVertex = INVALID_ID, moveColor = 0;
+				Int64 moveDelta = 0;
+				UInt32 ties = 0;
+
+				for (decltype(Vertex::Id) v = 0; v < n; v++)
+				{
+					auto p = &conflicts[(size_t)v * k];
+					if (p[trial[v]] == 0)
+						continue;
+
+					for (ID c = 0; c < k; c++)
+					{
+						if (c == trial[v])
+							continue;
+
+						Int64 delta = (Int64)p[c] - (Int64)p[trial[v]];
+						bool isAspiration = ((Int64)conflictCount + delta) < (Int64)bestCount;
+						if ((tabu[(size_t)v * k + c] >= iteration) && !isAspiration)
+							continue;
+
+						if ((moveVertex == INVALID_ID) || (delta < moveDelta))
+						{
+							moveVertex = v;
+							moveColor = c;
+							moveDelta = delta;
+							ties = 1;
+						}
+						else if ((delta == moveDelta) && (random.Next(++ties) == 0))
+						{
+							moveVertex = v;
+							moveColor = c;
+						}
+					}
+				}
+
+				if (moveVertex == INVALID_ID)
+					continue;
+
+				auto previous = trial[moveVertex];
+				trial[moveVertex] = moveColor;
+				conflictCount = (size_t)((Int64)conflictCount + moveDelta);
+				if (conflictCount < bestCount)
+					bestCount = conflictCount;
+
+				tabu[(size_t)moveVertex * k + previous] = iteration + (UInt32)(0.6 * conflictCount) + random.Next(10);
+
+				ForEachBit((UInt64*)_graph[moveVertex].Neighbours, qwords, [&](ID u)
+				{
+					if (u == moveVertex)
+						return;
+
+					conflicts[(size_t)u * k + previous]--;
+					conflicts[(size_t)u * k + moveColor]++;
+				});
+			}
+
+			if (conflictCount > 0)
+				break;
+
+			for (decltype(Vertex::Id) v = 0; v < n; v++)
+				_color[v] = trial[v] + 1;
+			_colors = k;
+		}
+
+		return _colors;
+	}
+
+	//	Renumbers _color to 1.._colors without gaps (a tabu attempt may leave a color unused); returns the colors used.
+	static decltype(Vertex::Id) CompactColors(ID* _color, decltype(Vertex::Id) _size, decltype(Vertex::Id) _colors)
+	{
+		std::vector<ID> map(_colors + 1, 0);
+		decltype(Vertex::Id) colors = 0;
+
+		for (decltype(Vertex::Id) v = 0; v < _size; v++)
+			map[_color[v]] = 1;
+
+		for (decltype(Vertex::Id) c = 1; c <= _colors; c++)
+			if (map[c] != 0)
+				map[c] = ++colors;
+
+		for (decltype(Vertex::Id) v = 0; v < _size; v++)
+			_color[v] = map[_color[v]];
+
+		return colors;
+	}
+
+	decltype(Vertex::Id) GetColoring(Ext::Array<Vertex> _graph, ColoringMode _mode, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets,
+		Ext::Array<ID> _vertexColor, UInt32 _tabuIterations, UInt32 _threads, UInt64 _seed, UInt32 _timeLimitMs)
+	{
+		if (_mode == ColoringMode::Exact)
+			return GetIndependentSets(_graph, _pSets, _vertexColor);
+
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_timeLimitMs);
+		auto n = (decltype(Vertex::Id))_graph.size();
+		std::vector<ID> color(n);
+		decltype(Vertex::Id) colors;
+
+		switch (_mode)
+		{
+		case ColoringMode::DSatur:
+			colors = ColorDSatur(_graph, color.data());
+			break;
+		case ColoringMode::RecursiveLargestFirst:
+			colors = ColorRecursiveLargestFirst(_graph, color.data());
+			break;
+		case ColoringMode::JonesPlassmann:
+			colors = ColorJonesPlassmann(_graph, color.data(), _threads, _seed);
+			break;
+		default:
+			throw "invalid _mode.";
+		}
+
+		if (_tabuIterations > 0)
+			colors = CompactColors(color.data(), n, ImproveColoringTabu(_graph, color.data(), colors, _tabuIterations, (_timeLimitMs > 0) ? &deadline : nullptr));
+
+		assert(IsValidColoring(_graph, color.data()));
+
+		for (decltype(Vertex::Id) v = 0; (v < n) && (v < _vertexColor.size()); v++)
+			_vertexColor[v] = color[v];
+
+		if (_pSets != nullptr)
+			GetColorClasses(color.data(), n, colors, *_pSets);
+
+		return colors;
+	}
+
+	void GetColorClasses(const ID* _vertexColor, decltype(Vertex::Id) _size, decltype(Vertex::Id) _colors, Ext::ArrayOfArray<Graph::ID, Graph::ID>& _sets)
+	{
+		std::vector<ID> members(_size);
+		for (decltype(Vertex::Id) c = 1; c <= _colors; c++)
+		{
+			decltype(Vertex::Id) size = 0;
+			for (decltype(Vertex::Id) v = 0; v < _size; v++)
+				if (_vertexColor[v] == c)
+					members[size++] = v;
+
+			auto set = _sets.setCount();
+			_sets.InitSet(set, size);
+			for (decltype(Vertex::Id) i = 0; i < size; i++)
+				_sets.Get(set, i) = members[i];
+		}
+	}
+}
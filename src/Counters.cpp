@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "Counters.h"
+#include "MemoryAllocation.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Graph
+{
+	namespace Clique
+	{
+		struct CounterInfo
+		{
+			const char* Name;
+			const char* Description;
+		};
+
+		// In the order of Counter.
+		static const CounterInfo s_Counters[] =
+		{
+			{ "Calls",				"TryFindClique invocations (subproblems searched)." },
+			{ "PartitionExtr",		"Partitions (a vertex and its equivalent vertices) removed as one clique member." },
+			{ "TwoNHits",			"Subgraphs pruned by the edge count bound." },
+			{ "TwoNColorHits",		"Subgraphs pruned by the coloring bound of the complement." },
+			{ "TwoNColorMisses",	"Coloring bounds computed that did not prune." },
+			{ "ColorBoundSkips",	"Coloring bounds skipped for want of graph memory under the budget." },
+			{ "SubgraphHits",		"Pivot neighbourhood subgraphs examined." },
+			{ "BtmUpHits",			"Vertices found equivalent to the pivot and removed with it." },
+			{ "BtmUpHits2",			"Pivot neighbourhoods not searched; too small for the clique sought." },
+			{ "BtmUpCheck",			"Pivot neighbourhoods recomputed over the vertices still active." },
+			{ "BtmUpCheck2",		"Common neighbour checks against the partitions taken so far." },
+			{ "EquivalenceMisses",	"Neighbours of the pivot tested for equivalence but not equivalent." },
+			{ "TargetsCovered",		"Subgraphs finished early; all targetted vertices were placed." },
+			{ "GraphEvictions",		"Ancestor graphs released under the memory budget (recreated on return)." },
+			{ "MaskedSubgraphs",	"Subproblems solved through masks on the parent graph under the memory budget." },
+		};
+
+		static_assert(sizeof(s_Counters) / sizeof(s_Counters[0]) == (size_t)Counter::Count, "s_Counters is out of sync with Counter.");
+
+		const char* GetCounterName(Counter _counter)
+		{
+			return (_counter < Counter::Count) ? s_Counters[(UInt32)_counter].Name : "";
+		}
+
+		const char* GetCounterDescription(Counter _counter)
+		{
+			return (_counter < Counter::Count) ? s_Counters[(UInt32)_counter].Description : "";
+		}
+
+		CounterSet::CounterSet(UInt32 _depths, bool _byDepth)
+			: ByDepth(nullptr), Depths((_depths == 0) ? 1 : _depths), Depth(0)
+		{
+			// Without CliqueCounters the depth is never tracked.
+			if (_byDepth && CliqueCounters)
+				ByDepth = (UInt64*)AllocMemory(sizeof(UInt64) * (UInt32)Counter::Count * Depths);
+
+			Clear();
+		}
+
+		CounterSet::~CounterSet()
+		{
+			if (ByDepth != nullptr)
+				FreeMemory(ByDepth);
+
+			ByDepth = nullptr;
+		}
+
+		void CounterSet::Clear()
+		{
+			memset(Totals, 0, sizeof(Totals));
+			if (ByDepth != nullptr)
+				memset(ByDepth, 0, sizeof(UInt64) * (UInt32)Counter::Count * Depths);
+
+			Depth = 0;
+		}
+
+		size_t CounterSet::FormatHeader(char* _sz, size_t _size) const
+		{
+			size_t length = 0;
+			for (UInt32 i = 0; (i < (UInt32)Counter::Count) && (length < _size); i++)
+				length += sprintf_s(_sz + length, _size - length, " %15s", s_Counters[i].Name);
+
+			return (length < _size) ? length : (_size - 1);
+		}
+
+		size_t CounterSet::FormatValues(char* _sz, size_t _size) const
+		{
+			size_t length = 0;
+			for (UInt32 i = 0; (i < (UInt32)Counter::Count) && (length < _size); i++)
+				length += sprintf_s(_sz + length, _size - length, " %15llu", Totals[i]);
+
+			return (length < _size) ? length : (_size - 1);
+		}
+
+		static void AppendJsonString(std::string& _text, const char* _value)
+		{
+			char sz[8];
+
+			_text += '"';
+			for (; *_value != 0; _value++)
+			{
+				if ((*_value == '"') || (*_value == '\\'))
+				{
+					_text += '\\';
+					_text += *_value;
+				}
+				else if ((byte)*_value < 0x20)
+				{
+					sprintf_s(sz, sizeof(sz), "\\u%04x", (int)(byte)*_value);
+					_text += sz;
+				}
+				else
+					_text += *_value;
+			}
+
+			_text += '"';
+		}
+
+		/*
+		*	Json :	{"label":..., "enabled":B, "counters":[{"name":..., "description":..., "total":N, "byDepth":[N, ...]}, ...]}
+		*	Csv  :	label,counter,depth,value; depth is "total" or 1 based.
+		*	byDepth rows run up to the deepest depth that counted an event.
+		*	Built with CliqueCounters=0, "enabled" is false and the counters other than Calls are null (Json) or have no
+		*	value (Csv), rather than a misleading 0.
+		*/
+		void CounterSet::Export(CounterFormat _format, const char* _label, std::string& _text) const
+		{
+			char sz[64];
+			UInt32 i, depth, depths = 0;
+
+			if (_label == nullptr)
+				_label = "";
+
+			if (ByDepth != nullptr)
+			{
+				for (depth = 0; depth < Depths; depth++)
+					for (i = 0; i < (UInt32)Counter::Count; i++)
+						if (ByDepth[depth * (UInt32)Counter::Count + i] != 0)
+							depths = depth + 1;
+			}
+
+			if (_format == CounterFormat::Csv)
+			{
+				_text += "label,counter,depth,value\n";
+				for (i = 0; i < (UInt32)Counter::Count; i++)
+				{
+					if (CliqueCounters || (i == (UInt32)Counter::Calls))
+						sprintf_s(sz, sizeof(sz), ",%s,total,%llu\n", s_Counters[i].Name, Totals[i]);
+					else
+						sprintf_s(sz, sizeof(sz), ",%s,total,\n", s_Counters[i].Name);
+
+					_text += _label;
+					_text += sz;
+
+					for (depth = 0; depth < depths; depth++)
+					{
+						sprintf_s(sz, sizeof(sz), ",%s,%u,%llu\n", s_Counters[i].Name, depth + 1, ByDepth[depth * (UInt32)Counter::Count + i]);
+						_text += _label;
+						_text += sz;
+					}
+				}
+
+				return;
+			}
+
+			_text += "{\"label\":";
+			AppendJsonString(_text, _label);
+			_text += CliqueCounters ? ",\"enabled\":true" : ",\"enabled\":false";
+			_text += ",\"counters\":[";
+
+			for (i = 0; i < (UInt32)Counter::Count; i++)
+			{
+				_text += (i == 0) ? "\n{\"name\":" : ",\n{\"name\":";
+				AppendJsonString(_text, s_Counters[i].Name);
+				_text += ",\"description\":";
+				AppendJsonString(_text, s_Counters[i].Description);
+
+				if (CliqueCounters || (i == (UInt32)Counter::Calls))
+					sprintf_s(sz, sizeof(sz), ",\"total\":%llu", Totals[i]);
+				else
+					strcpy_s(sz, sizeof(sz), ",\"total\":null");
+
+				_text += sz;
+
+				if (ByDepth != nullptr)
+				{
+					_text += ",\"byDepth\":[";
+					for (depth = 0; depth < depths; depth++)
+					{
+						sprintf_s(sz, sizeof(sz), (depth == 0) ? "%llu" : ",%llu", ByDepth[depth * (UInt32)Counter::Count + i]);
+						_text += sz;
+					}
+
+					_text += "]";
+				}
+
+				_text += "}";
+			}
+
+			_text += "\n]}\n";
+		}
+	}
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#pragma once
+
+#if (!Counters_H)
+#define Counters_H
+
+#include "GraphUtility.h"
+
+#include <string>
+
+/*
+*	CliqueCounters : 1 (default) counts the search events below; 0 removes every CountEvent() from the build,
+*	only Calls (the TryFindClique call sequence) is kept. Production builds define CliqueCounters=0.
+*/
+#if (!defined(CliqueCounters))
+#define CliqueCounters 1
+#endif
+
+namespace Graph
+{
+	namespace Clique
+	{
+		// Search events of TryFindClique; names and descriptions are in GetCounterName() / GetCounterDescription().
+		enum struct Counter : UInt32
+		{
+			Calls = 0,
+			PartitionExtr,
+			TwoNHits,
+			TwoNColorHits,
+			TwoNColorMisses,
+			ColorBoundSkips,
+			SubgraphHits,
+			BtmUpHits,
+			BtmUpHits2,
+			BtmUpCheck,
+			BtmUpCheck2,
+			EquivalenceMisses,
+			TargetsCovered,
+			GraphEvictions,
+			MaskedSubgraphs,
+
+			Count
+		};
+
+		const char* GetCounterName(Counter _counter);
+
+		const char* GetCounterDescription(Counter _counter);
+
+		/*
+		*	Totals of each Counter and, when enabled, a breakdown by search depth (Depths rows of Counter::Count).
+		*	Events are attributed to Depth, which TryFindClique keeps at the depth of the frame being processed.
+		*/
+		class CounterSet
+		{
+		public:
+			CounterSet(UInt32 _depths, bool _byDepth);
+			~CounterSet();
+
+			void Clear();
+
+			forceinline void Add(Counter _counter)
+			{
+				Totals[(UInt32)_counter]++;
+				if (ByDepth != nullptr)
+					ByDepth[Depth * (UInt32)Counter::Count + (UInt32)_counter]++;
+			}
+
+			forceinline void SetDepth(UInt32 _depth)
+			{
+				Depth = (_depth < Depths) ? _depth : (Depths - 1);
+			}
+
+			UInt64 Get(Counter _counter) const { return Totals[(UInt32)_counter]; }
+
+			// Writes one " %15s" column header / " %15llu" value per counter, in the order of Counter; returns the length written.
+			size_t FormatHeader(char* _sz, size_t _size) const;
+			size_t FormatValues(char* _sz, size_t _size) const;
+
+			void Export(CounterFormat _format, const char* _label, std::string& _text) const;
+
+		private:
+			CounterSet(const CounterSet&) = delete;
+			CounterSet& operator=(const CounterSet&) = delete;
+
+		private:
+			UInt64	Totals[(UInt32)Counter::Count];
+			UInt64	*ByDepth;
+			UInt32	Depths, Depth;
+		};
+	}
+}
+
+#if (CliqueCounters)
+#define CountEvent(counters, counter)			(counters).Add(Graph::Clique::Counter::counter)
+#define SetCounterDepth(counters, depth)		(counters).SetDepth((UInt32)(depth))
+#else
+#define CountEvent(counters, counter)			((void)0)
+#define SetCounterDepth(counters, depth)		((void)0)
+#endif
+
+#endif
@@ -174,7 +174,7 @@ namespace Graph
 					edgeCount--;
 			}
 
-			int size = sprintf_s(line, sizeof(line), "c FILE: %s\nc%-64s\nc Graph Size:%I64d\nc\np edge %I64d %I64d\n", _name, "", _graph.size(), _graph.size(), edgeCount / 2);
+			int size = sprintf_s(line, sizeof(line), "c FILE: %s\nc%-64s\nc Graph Size:%lld\nc\np edge %lld %lld\n", _name, "", (long long)_graph.size(), (long long)_graph.size(), (long long)(edgeCount / 2));
 			int size2 = sprintf_s(szCount, sizeof(szCount), "%d\n", size);
 
 			fwrite(szCount, 1, size2, fsOut);
@@ -270,7 +270,9 @@ namespace Graph
 			formula.Variables = varialbes;
 			formula.Clauses.ctor(new byte[Ext::ArrayOfArray<int, ID>::GetAllocationSize((ID)clauses, (ID)literals.size())], (ID)clauses, (ID)literals.size());
 
-			memcpy(formula.Clauses.ptrList(), literals._Myfirst(), sizeof(int) * literals.size());
+			memcpy(formula.Clauses.ptrList(), literals.data(), sizeof(int) * literals.size());
+
+			// an empty clause is kept; Solve() reports the formula unsatisfiable.
 			for (int i = 0; i < clauses; i++)
 				formula.Clauses.InitSet(i, ID(offset[i + 1] - offset[i]));
 
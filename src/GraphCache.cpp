@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "GraphUtility.h"
+#include "graph_types.h"
+
+#include <stdio.h>
+#include <memory.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Graph
+{
+	//
+	//	Cache file layout
+	//		GraphCacheHeader
+	//		Count		:	ID[Vertices]								(QWord aligned)
+	//		Neighbours	:	byte[RowSize] * Vertices				(starts at RowsOffset)
+	//
+	//	Rows are stored in CreateGraph() layout so that a mapped view is used in place.
+	//
+
+	static const char GraphCacheMagic[8] = { 'C', 'L', 'Q', 'G', 'R', 'P', 'H', 0 };
+	static const UInt32 GraphCacheVersion = 1;
+
+	struct GraphCacheHeader
+	{
+		char		Magic[8];
+		UInt32	Version;
+		UInt32	Reserved;
+		UInt64	Vertices;
+		UInt64	RowSize;
+		UInt64	CountsOffset;
+		UInt64	RowsOffset;
+		UInt64	Reserved2[2];
+	};
+
+	struct GraphCacheView
+	{
+		void*		Base;
+		size_t	Length;
+#ifdef _WIN32
+		HANDLE	File;
+		HANDLE	Mapping;
+#endif
+	};
+
+	inline UInt64 GetRowsOffset(UInt64 _vertices)
+	{
+		return (GetQWordAlignedSize(sizeof(GraphCacheHeader) + GetQWordAlignedSize(sizeof(ID) * _vertices)) + 63) & ~(UInt64)63;
+	}
+
+	bool SaveGraphCache(const char* _cacheFile, Ext::Array<Vertex> _graph)
+	{
+		if ((_cacheFile == nullptr) || (*_cacheFile == 0))
+			return false;
+
+		FILE	*fsOut = nullptr;
+		byte	*buffer = nullptr;
+
+		try
+		{
+			if (fopen_s(&fsOut, _cacheFile, "wb") != 0)
+				return false;
+
+			GraphCacheHeader header;
+			memset(&header, 0, sizeof(header));
+			memcpy(header.Magic, GraphCacheMagic, sizeof(header.Magic));
+			header.Version = GraphCacheVersion;
+			header.Vertices = _graph.size();
+			header.RowSize = GetQWordAlignedSizeForBits(_graph.size());
+			header.CountsOffset = sizeof(GraphCacheHeader);
+			header.RowsOffset = GetRowsOffset(_graph.size());
+
+			size_t countsSize = (size_t)(header.RowsOffset - header.CountsOffset);
+			buffer = new byte[(countsSize > header.RowSize) ? countsSize : (size_t)header.RowSize];
+			memset(buffer, 0, countsSize);
+			for (size_t i = 0; i < _graph.size(); i++)
+				((ID*)buffer)[i] = _graph[i].Count;
+
+			bool isWritten = (fwrite(&header, sizeof(header), 1, fsOut) == 1) && (fwrite(buffer, 1, countsSize, fsOut) == countsSize);
+			for (size_t i = 0; isWritten && (i < _graph.size()); i++)
+				isWritten = (fwrite(_graph[i].Neighbours, 1, (size_t)header.RowSize, fsOut) == header.RowSize);
+
+			delete[] buffer;
+			fclose(fsOut);
+
+			return isWritten;
+		}
+		catch (...)
+		{
+			if (buffer != nullptr)
+				delete[] buffer;
+
+			if (fsOut != nullptr)
+				fclose(fsOut);
+		}
+
+		return false;
+	}
+
+	Ext::Array<Vertex> MapGraphCache(const char* _cacheFile)
+	{
+		GraphCacheView view;
+		memset(&view, 0, sizeof(view));
+
+#ifdef _WIN32
+		view.File = CreateFileA(_cacheFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (view.File == INVALID_HANDLE_VALUE)
+			return Ext::Array<Vertex>();
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(view.File, &fileSize) || (fileSize.QuadPart < (LONGLONG)sizeof(GraphCacheHeader)))
+		{
+			CloseHandle(view.File);
+			return Ext::Array<Vertex>();
+		}
+
+		view.Length = (size_t)fileSize.QuadPart;
+		view.Mapping = CreateFileMappingA(view.File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		view.Base = (view.Mapping == nullptr) ? nullptr : MapViewOfFile(view.Mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view.Base == nullptr)
+		{
+			if (view.Mapping != nullptr)
+				CloseHandle(view.Mapping);
+
+			CloseHandle(view.File);
+			return Ext::Array<Vertex>();
+		}
+#else
+		int fd = open(_cacheFile, O_RDONLY);
+		if (fd < 0)
+			return Ext::Array<Vertex>();
+
+		struct stat st;
+		if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(GraphCacheHeader)))
+		{
+			close(fd);
+			return Ext::Array<Vertex>();
+		}
+
+		view.Length = (size_t)st.st_size;
+		view.Base = mmap(nullptr, view.Length, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (view.Base == MAP_FAILED)
+			return Ext::Array<Vertex>();
+#endif
+
+		auto header = (GraphCacheHeader*)view.Base;
+		byte* base = (byte*)view.Base;
+
+		// Vertices is bounded by the file length first so that neither the offsets nor the rows size can overflow.
+		if ((memcmp(header->Magic, GraphCacheMagic, sizeof(header->Magic)) != 0) || (header->Version != GraphCacheVersion) ||
+			(header->Vertices == 0) || (header->Vertices > view.Length / sizeof(ID)) ||
+			(header->RowSize != GetQWordAlignedSizeForBits(header->Vertices)) || (header->RowsOffset != GetRowsOffset(header->Vertices)) ||
+			(header->RowsOffset > view.Length) || (header->RowSize > (view.Length - header->RowsOffset) / header->Vertices))
+		{
+			Ext::Array<Vertex> graph((Vertex*)nullptr, 0);
+#ifdef _WIN32
+			UnmapViewOfFile(view.Base);
+			CloseHandle(view.Mapping);
+			CloseHandle(view.File);
+#else
+			munmap(view.Base, view.Length);
+#endif
+			return graph;
+		}
+
+		// Vertex array is followed by the view descriptor used by UnmapGraphCache().
+		size_t vertices = (size_t)header->Vertices;
+		byte* ptr = new byte[GetQWordAlignedSize(sizeof(Vertex) * vertices) + sizeof(GraphCacheView)];
+		Ext::Array<Vertex> graph((Vertex*)ptr, vertices);
+		ID* counts = (ID*)(base + header->CountsOffset);
+		byte* rows = base + header->RowsOffset;
+
+		for (size_t i = 0; i < vertices; i++)
+		{
+			graph[i].Id = (ID)i;
+			graph[i].Count = counts[i];
+			graph[i].Neighbours = rows + header->RowSize * i;
+		}
+
+		*(GraphCacheView*)(ptr + GetQWordAlignedSize(sizeof(Vertex) * vertices)) = view;
+
+		return graph;
+	}
+
+	void UnmapGraphCache(Ext::Array<Vertex>& _graph)
+	{
+		if (_graph.ptr() == nullptr)
+			return;
+
+		byte* ptr = (byte*)_graph.ptr();
+		GraphCacheView view = *(GraphCacheView*)(ptr + GetQWordAlignedSize(sizeof(Vertex) * _graph.size()));
+
+#ifdef _WIN32
+		UnmapViewOfFile(view.Base);
+		CloseHandle(view.Mapping);
+		CloseHandle(view.File);
+#else
+		munmap(view.Base, view.Length);
+#endif
+
+		delete[] ptr;
+		_graph = Ext::Array<Vertex>();
+	}
+}
@@ -15,19 +15,21 @@
 #include "graph_types.h"
 #include "PrivateTypes.h"
 #include "Bit.h"
+#include "MemoryAllocation.h"
 
 #include <memory.h>
 #include <stdio.h>
+#include <algorithm>
 
 namespace Graph
 {
 
-	Ext::Array<Vertex> CreateGraph(size_t _count, void* _ptr)
+	Ext::Array<Vertex> CreateGraph(size_t _count, void* _ptr, bool _zeroNeighbours)
 	{
 		if (_count <= 0)
 			return Ext::Array<Vertex>((Vertex*)_ptr, 0);
 
-		ZeroMemoryPack8(_ptr, GetGraphAllocationSize(_count));
+		ZeroMemoryPack8(_ptr, _zeroNeighbours ? GetGraphAllocationSize(_count) : GetQWordAlignedSize(sizeof(Vertex) * _count));
 
 		size_t size = GetQWordAlignedSizeForBits(_count);
 		byte* ptr = (byte*)_ptr;
@@ -46,13 +48,13 @@ namespace Graph
 
 	Ext::Array<Vertex> CreateGraph(size_t _count)
 	{
-		return CreateGraph(_count, (_count <= 0) ? nullptr : new byte[GetGraphAllocationSize(_count)]);
+		return CreateGraph(_count, (_count <= 0) ? nullptr : AllocMemory(GetGraphAllocationSize(_count)));
 	}
 
 	void FreeGraph(Ext::Array<Vertex>& _graph)
 	{
 		if (_graph.ptr() != nullptr)
-			delete[] (byte*)_graph.ptr();
+			FreeMemory(_graph.ptr());
 
 		_graph = Ext::Array<Vertex>();
 	}
@@ -263,6 +265,43 @@ namespace Graph
 		}
 	}
 
+	void TransposeBits64(UInt64* _block)
+	{
+		// Swaps the off diagonal halves of the 32x32 quadrants, then of the 16x16 sub-blocks, ... down to single bits.
+		UInt64 mask = 0x00000000FFFFFFFFULL;
+		for (UInt32 j = 32; j != 0; j >>= 1, mask ^= (mask << j))
+		{
+			for (UInt32 k = 0; k < 64; k = ((k | j) + 1) & ~j)
+			{
+				UInt64 t = ((_block[k] >> j) ^ _block[k | j]) & mask;
+				_block[k] ^= t << j;
+				_block[k | j] ^= t;
+			}
+		}
+	}
+
+	void MirrorLowerTriangle(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _size)
+	{
+		UInt64 block[64];
+		size_t blocks = GetQWordSizeForBits(_size);
+
+		// Block (r, c), c <= r : word c of the rows [64r, 64r + 64); its transpose is ORed into word r of the rows
+		// [64c, 64c + 64). Blocks above the diagonal are only written, so every block is read before it changes.
+		for (size_t r = 0; r < blocks; r++)
+		{
+			for (size_t c = 0; c <= r; c++)
+			{
+				for (size_t i = 0; i < 64; i++)
+					block[i] = ((r * 64 + i) < _size) ? ((UInt64*)_graph[r * 64 + i].Neighbours)[c] : 0;
+
+				TransposeBits64(block);
+
+				for (size_t i = 0; (i < 64) && ((c * 64 + i) < _size); i++)
+					((UInt64*)_graph[c * 64 + i].Neighbours)[r] |= block[i];
+			}
+		}
+	}
+
 	void ComplementGraph(Ext::Array<Vertex> _src, Ext::Array<Vertex> _complement)
 	{
 		if (_src.size() != _complement.size())
@@ -271,26 +310,42 @@ namespace Graph
 		if (_src.size() == 0)
 			return;
 
-		size_t size = GetQWordAlignedSizeForBits(_src.size());
-		for (size_t j = 0, i = 0; i < _src.size(); i++)
+		size_t words = GetQWordSizeForBits(_src.size());
+
+		// Valid bits of the last word, in memory order.
+		UInt64 lastWordMask = ~0ULL;
+		if ((_src.size() & 63) != 0)
+			SetNBits(&lastWordMask, _src.size() & 63);
+
+		for (size_t i = 0; i < _src.size(); i++)
 		{
-			auto neighbours = _complement[i].Neighbours;
-			auto srcNeighbours = _src[i].Neighbours;
-			bool isSelfEdgeExist = BitTest(srcNeighbours, (decltype(Vertex::Id))i);
+			auto neighbours = (UInt64*)_complement[i].Neighbours;
+			auto srcNeighbours = (UInt64*)_src[i].Neighbours;
+			bool isSelfEdgeExist = BitTest(_src[i].Neighbours, (decltype(Vertex::Id))i);
+			size_t j, count = 0;
 
-			for (j = 0; j < (_complement.size() / 8); j++)
+			for (j = 0; (j + 1) < words; j++)
+			{
 				neighbours[j] = ~srcNeighbours[j];
-			if ((_complement.size() % 8) != 0)
-				neighbours[j++] = srcNeighbours[j] ^ ((byte)((1 << (_complement.size() % 8)) - 1));
-			for (; j < size; j++)
-				((byte*)neighbours)[j] = 0;
+				count += PopCount64(neighbours[j]);
+			}
+
+			neighbours[j] = ~srcNeighbours[j] & lastWordMask;
+			count += PopCount64(neighbours[j]);
 
+			// The diagonal keeps the self edge of _src; the complement above flipped it.
 			if (isSelfEdgeExist)
-				BitSet(neighbours, (decltype(Vertex::Id))i);
+			{
+				BitSet(_complement[i].Neighbours, (decltype(Vertex::Id))i);
+				count++;
+			}
 			else
-				BitReset(neighbours, (decltype(Vertex::Id))i);
+			{
+				BitReset(_complement[i].Neighbours, (decltype(Vertex::Id))i);
+				count--;
+			}
 
-			_complement[i].Count = (decltype(Vertex::Id))PopCount((UInt64*)neighbours, size >> 3);
+			_complement[i].Count = (decltype(Vertex::Id))count;
 		}
 	}
 
@@ -414,7 +469,7 @@ namespace Graph
 				if (_to[j].Count > 0)
 				{
 					_to[j].Count = 0;
-					ZeroMemoryPack8(_to[j].Neighbours, _to.size() + 7);
+					ZeroMemoryPack8(_to[j].Neighbours, GetQWordAlignedSizeForBits(_to.size()));
 				}
 
 				auto dest = _to[j].Neighbours;
@@ -428,17 +483,24 @@ namespace Graph
 				j++;
 			}
 
-			for (j = 0; j < size; j++)
+			// A block transpose costs about as much as mirroring 32 rows pair by pair.
+			if (IsLittleEndian() && (size >= 32))
+				MirrorLowerTriangle(_to, size);
+			else
 			{
-				auto dest = _to[j].Neighbours;
-				for (k = j + 1; k < size; k++)
+				for (j = 0; j < size; j++)
 				{
-					if (BitTest(_to[k].Neighbours, j))
-						BitSet(dest, k);
+					auto dest = _to[j].Neighbours;
+					for (k = j + 1; k < size; k++)
+					{
+						if (BitTest(_to[k].Neighbours, j))
+							BitSet(dest, k);
+					}
 				}
-
-				_to[j].Count = (decltype(Vertex::Id))PopCount((UInt64*)dest, GetQWordSizeForBits(_to.size()));
 			}
+
+			for (j = 0; j < size; j++)
+				_to[j].Count = (decltype(Vertex::Id))PopCount((UInt64*)_to[j].Neighbours, GetQWordSizeForBits(_to.size()));
 		}
 		else if (IsLittleEndian())
 		{
@@ -541,7 +603,91 @@ namespace Graph
 		for (i = size; i < _to.size(); i++)
 		{
 			_to[i].Count = 0;
-			ZeroMemoryPack8(_to[i].Neighbours, _to.size() + 7);
+			ZeroMemoryPack8(_to[i].Neighbours, GetQWordAlignedSizeForBits(_to.size()));
+		}
+
+		return true;
+	}
+
+	bool ExtractComplementGraph(Ext::Array<Vertex> _from, Ext::Array<Vertex> _to, byte* _mask, byte* _sizeOfBitset)
+	{
+		size_t chuncks = GetQWordSizeForBits(_from.size());
+		auto size = (decltype(Vertex::Id))PopCount((UInt64*)_mask, chuncks);
+		if (_to.size() != size)
+			return false;
+
+		decltype(Vertex::Id) i, j, k, l;
+
+		// Few vertices (ExtractGraph copies them bit by bit) or big endian : extract, then complement in place.
+		if ((size <= chuncks) || !IsLittleEndian())
+		{
+			for (j = 0; j < size; j++)
+			{
+				_to[j].Count = 0;
+				ZeroMemoryPack8(_to[j].Neighbours, GetQWordAlignedSizeForBits(size));
+			}
+
+			ExtractGraph(_from, _to, _mask, _sizeOfBitset);
+			ComplementGraph(_to, _to);
+			return true;
+		}
+
+		auto mask = (UInt64*)_mask;
+
+		for (k = 0; k < chuncks; k++)
+			_sizeOfBitset[k] = (byte)PopCount64(mask[k]);
+
+		// As ExtractGraph with ~src; every word of a row is written, so _to need not be zeroed.
+		for (j = 0, i = 0; i < _from.size(); i++)
+		{
+			if (!BitTest(_mask, i))
+				continue;
+
+			auto dest = (decltype(mask))_to[j].Neighbours;
+			auto src = (decltype(mask))_from[i].Neighbours;
+			size_t count = 0, count2 = 0;
+
+			for (l = 0, dest[l] = 0, k = 0; k < chuncks; k++)
+			{
+				if (mask[k] == 0)
+					continue;
+
+				byte bitsCount = (byte)(count & 0x3F);
+				auto bits = _pext_u64(~src[k], mask[k]);
+
+				dest[l] |= (bits << bitsCount);
+				count += _sizeOfBitset[k];
+
+				if ((bitsCount + _sizeOfBitset[k]) < 64)
+					continue;
+
+				count2 += PopCount64(dest[l]);
+				l++;
+
+				if (_sizeOfBitset[k] > (64 - bitsCount))
+					dest[l] = (bits >> (64 - bitsCount));
+				else if (count < size)
+					dest[l] = 0;
+			}
+
+			if ((count & 0x3F) > 0)
+				count2 += PopCount64(dest[l]);
+
+			// The self edge stays as it is in _from, as ComplementGraph keeps it.
+			if (BitTest(_from[i].Neighbours, i))
+			{
+				BitSet(_to[j].Neighbours, j);
+				count2++;
+			}
+			else
+			{
+				BitReset(_to[j].Neighbours, j);
+				count2--;
+			}
+
+			_to[j].Count = (decltype(Vertex::Count))count2;
+
+			j++;
 		}
 
 		return true;
@@ -730,6 +876,224 @@ namespace Graph
 	}
 
 
+	// Words kept by row _vertex of a triangular graph of _words words per dense row : from _vertex / 64 on.
+	inline size_t GetTriangularRowWords(size_t _words, size_t _vertex)
+	{
+		return _words - (_vertex >> 6);
+	}
+
+	size_t GetTriangularGraphAllocationSize(size_t _count)
+	{
+		size_t words = GetQWordSizeForBits(_count), size = 0;
+
+		// Each block row of 64 vertices keeps one word less than the one above.
+		for (size_t i = 0; i < _count; i += 64)
+			size += ((_count - i) < 64 ? (_count - i) : 64) * GetTriangularRowWords(words, i);
+
+		return GetQWordAlignedSize(sizeof(Vertex) * _count) + size * sizeof(UInt64);
+	}
+
+	TriangularGraph CreateTriangularGraph(Ext::Array<Vertex> _graph, void* _ptr)
+	{
+		TriangularGraph graph;
+		if (_graph.size() == 0)
+			return graph;
+
+		size_t words = GetQWordSizeForBits(_graph.size());
+		byte* ptr = (byte*)((_ptr == nullptr) ? AllocMemory(GetTriangularGraphAllocationSize(_graph.size())) : _ptr);
+
+		graph.Rows = Ext::Array<Vertex>((Vertex*)ptr, _graph.size());
+		ptr += GetQWordAlignedSize(sizeof(Vertex) * _graph.size());
+
+		for (size_t i = 0; i < _graph.size(); i++)
+		{
+			size_t rowWords = GetTriangularRowWords(words, i);
+
+			graph.Rows[i].Id = _graph[i].Id;
+			graph.Rows[i].Count = _graph[i].Count;
+			graph.Rows[i].Neighbours = ptr;
+			CopyMemoryPack8(ptr, ((UInt64*)_graph[i].Neighbours) + (i >> 6), rowWords * sizeof(UInt64));
+
+			ptr += rowWords * sizeof(UInt64);
+		}
+
+		return graph;
+	}
+
+	void FreeTriangularGraph(TriangularGraph& _graph)
+	{
+		if (_graph.Rows.ptr() != nullptr)
+			FreeMemory(_graph.Rows.ptr());
+
+		_graph.Rows = Ext::Array<Vertex>();
+	}
+
+	byte* GetTriangularGraphRow(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex, byte* _row)
+	{
+		size_t words = GetQWordSizeForBits(_graph.size()), first = _vertex >> 6;
+
+		ZeroMemoryPack8(_row, first * sizeof(UInt64));
+		CopyMemoryPack8(((UInt64*)_row) + first, _graph.Rows[_vertex].Neighbours, GetTriangularRowWords(words, _vertex) * sizeof(UInt64));
+
+		// Below the diagonal block : column _vertex of the rows [0, 64 * first), each of which keeps word first.
+		for (size_t j = 0; j < (first << 6); j++)
+		{
+			if (BitTest(_graph.Rows[j].Neighbours, (size_t)_vertex - ((j >> 6) << 6)))
+				BitSet(_row, j);
+		}
+
+		return _row;
+	}
+
+	// Scratch row of a thread for GetTriangularGraphRow(); grows to the largest graph seen.
+	struct TriangularRowScratch
+	{
+		TriangularRowScratch()
+			: Row(nullptr), Size(0)
+		{
+		}
+
+		~TriangularRowScratch()
+		{
+			if (Row != nullptr)
+				FreeMemory(Row);
+		}
+
+		byte* Get(size_t _size)
+		{
+			if (_size > Size)
+			{
+				if (Row != nullptr)
+					FreeMemory(Row);
+
+				Row = (byte*)AllocMemory(_size);
+				Size = (Row == nullptr) ? 0 : _size;
+			}
+
+			return Row;
+		}
+
+		byte	*Row;
+		size_t	Size;
+	};
+
+	static thread_local TriangularRowScratch s_TriangularRowScratch;
+
+	byte* GetTriangularGraphRow(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex)
+	{
+		auto row = s_TriangularRowScratch.Get(GetQWordAlignedSizeForBits(_graph.size()));
+		if (row == nullptr)
+			throw "out of memory.";
+
+		return GetTriangularGraphRow(_graph, _vertex, row);
+	}
+
+	Ext::Array<Vertex> CloneGraph(const TriangularGraph& _graph, void* _ptr)
+	{
+		size_t n = _graph.size(), words = GetQWordSizeForBits(n);
+		auto graph = (_ptr == nullptr) ? CreateGraph(n) : CreateGraph(n, _ptr);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			graph[i].Id = _graph.Rows[i].Id;
+			graph[i].Count = _graph.Rows[i].Count;
+		}
+
+		if (!IsLittleEndian())
+		{
+			for (size_t i = 0; i < n; i++)
+				GetTriangularGraphRow(_graph, (decltype(Vertex::Id))i, graph[i].Neighbours);
+
+			return graph;
+		}
+
+		for (size_t i = 0; i < n; i++)
+			CopyMemoryPack8(((UInt64*)graph[i].Neighbours) + (i >> 6), _graph.Rows[i].Neighbours, GetTriangularRowWords(words, i) * sizeof(UInt64));
+
+		// Block (r, c), c < r, is the transpose of block (c, r) : word r of the rows [64c, 64c + 64), kept at word
+		// (r - c) of their triangular rows.
+		UInt64 block[64];
+		for (size_t c = 0; c < words; c++)
+		{
+			for (size_t r = c + 1; r < words; r++)
+			{
+				for (size_t i = 0; i < 64; i++)
+					block[i] = ((c * 64 + i) < n) ? ((UInt64*)_graph.Rows[c * 64 + i].Neighbours)[r - c] : 0;
+
+				TransposeBits64(block);
+
+				for (size_t i = 0; (i < 64) && ((r * 64 + i) < n); i++)
+					((UInt64*)graph[r * 64 + i].Neighbours)[c] = block[i];
+			}
+		}
+
+		return graph;
+	}
+
+	bool ExtractGraph(const TriangularGraph& _from, Ext::Array<Vertex> _to, byte* _mask, byte* _sizeOfBitset)
+	{
+		auto size = (decltype(Vertex::Id))PopCount((UInt64*)_mask, GetQWordSizeForBits(_from.size()));
+		if (_to.size() < size)
+			return false;
+
+		decltype(Vertex::Id) i, j;
+
+		// Each row is rebuilt in the scratch row, then packed as ExtractBits does for a dense row.
+		for (j = 0, i = 0; j < size; i++)
+		{
+			if (!BitTest(_mask, i))
+				continue;
+
+			_to[j].Count = (decltype(Vertex::Count))ExtractBits(GetTriangularGraphRow(_from, i), _to[j].Neighbours, _mask, _sizeOfBitset, _from.size());
+			j++;
+		}
+
+		for (i = size; i < _to.size(); i++)
+		{
+			_to[i].Count = 0;
+			ZeroMemoryPack8(_to[i].Neighbours, GetQWordAlignedSizeForBits(_to.size()));
+		}
+
+		return true;
+	}
+
+	bool IsCorrupt(const TriangularGraph& _graph)
+	{
+		for (size_t i = 0; i < _graph.size(); i++)
+		{
+			if ((_graph.Rows[i].Neighbours == nullptr) || (_graph.Rows[i].Count > _graph.size()))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool IsClique(const TriangularGraph& _graph, decltype(Vertex::Id) *_cliqueMembers, decltype(Vertex::Id) _cliqueSize, byte* _bitset)
+	{
+		decltype(Vertex::Id) i;
+		auto bitSetLength = (decltype(Vertex::Id))GetQWordAlignedSizeForBits(_graph.size());
+
+		ZeroMemoryPack8(_bitset, bitSetLength);
+		for (i = 0; i < _cliqueSize; i++)
+		{
+			if (BitTest(_bitset, _cliqueMembers[i]))
+				return false;	// invalidArgument : duplicate found in _cliqueMembers
+
+			BitSet(_bitset, _cliqueMembers[i]);
+		}
+
+		for (i = 0; i < _cliqueSize; i++)
+		{
+			auto id = _cliqueMembers[i];
+			auto row = GetTriangularGraphRow(_graph, id);
+			auto count = PopCountAandB((UInt64*)_bitset, (UInt64*)row, (bitSetLength >> 3));
+			if ((count != _cliqueSize) && (((count + 1) != _cliqueSize) || BitTest(row, id)))
+				return false;
+		}
+
+		return true;
+	}
+
 	bool IsSame(Ext::Array<Vertex> _graph, Ext::Array<Vertex> _graph2)
 	{
 		if (_graph.size() != _graph2.size())
@@ -1170,4 +1534,232 @@ namespace Graph
 		return true;
 	}
 
+	decltype(Vertex::Id) GetDegeneracyOrder(Ext::Array<Vertex> _graph, Ext::Array<ID> _order)
+	{
+		auto n = (decltype(Vertex::Id))_graph.size();
+		if (_order.size() < n)
+			throw "invalid _order.";
+
+		//	Minimum degree vertex is removed first; degree excludes self edge. O(n^2) which is the cost of reading the bit matrix.
+		size_t qwords = GetQWordSizeForBits(n);
+		ID *degree = new ID[n + 1];
+		byte *removed = new byte[GetQWordAlignedSizeForBits(n)];
+		decltype(Vertex::Id) i, degeneracy = 0;
+
+		ZeroMemoryPack8(removed, GetQWordAlignedSizeForBits(n));
+		for (i = 0; i < n; i++)
+			degree[i] = _graph[i].Count - (BitTest(_graph[i].Neighbours, i) ? 1 : 0);
+
+		for (i = 0; i < n; i++)
+		{
+			decltype(Vertex::Id) j, u = INVALID_ID;
+			for (j = 0; j < n; j++)
+			{
+				if (!BitTest(removed, j) && ((u == INVALID_ID) || (degree[j] < degree[u])))
+					u = j;
+			}
+
+			_order[i] = u;
+			degeneracy = (degree[u] > degeneracy) ? degree[u] : degeneracy;
+			BitSet(removed, u);
+
+			auto neighbours = (UInt64*)_graph[u].Neighbours;
+			for (size_t k = 0; k < qwords; k++)
+			{
+				UInt64 bits = neighbours[k] & ~((UInt64*)removed)[k];
+				while (bits != 0)
+				{
+					unsigned long pos;
+					_BitScanForward64(&pos, bits);
+					_bittestandreset64((Int64*)&bits, pos);
+					degree[(k << 6) + pos]--;
+				}
+			}
+		}
+
+		delete[] removed;
+		delete[] degree;
+
+		return degeneracy;
+	}
+
+	// Reverse Cuthill-McKee : breadth first from a minimum degree vertex of each component, neighbours by ascending degree.
+	static void GetBandwidthOrder(Ext::Array<Vertex> _graph, ID* _order)
+	{
+		auto n = (decltype(Vertex::Id))_graph.size();
+		size_t qwords = GetQWordSizeForBits(n);
+		byte *visited = new byte[GetQWordAlignedSizeForBits(n)];
+		ID *byDegree = new ID[n + 1];
+		decltype(Vertex::Id) i, head = 0, tail = 0;
+
+		ZeroMemoryPack8(visited, GetQWordAlignedSizeForBits(n));
+		for (i = 0; i < n; i++)
+			byDegree[i] = i;
+
+		auto isLess = [&_graph](ID _a, ID _b) { return (_graph[_a].Count < _graph[_b].Count) || ((_graph[_a].Count == _graph[_b].Count) && (_a < _b)); };
+		std::sort(byDegree, byDegree + n, isLess);
+
+		for (i = 0; i < n; i++)
+		{
+			if (BitTest(visited, byDegree[i]))
+				continue;
+
+			BitSet(visited, byDegree[i]);
+			_order[tail++] = byDegree[i];
+
+			for (; head < tail; head++)
+			{
+				auto neighbours = (UInt64*)_graph[_order[head]].Neighbours;
+				auto first = tail;
+
+				for (size_t k = 0; k < qwords; k++)
+				{
+					UInt64 bits = neighbours[k] & ~((UInt64*)visited)[k];
+					((UInt64*)visited)[k] |= bits;
+
+					while (bits != 0)
+					{
+						unsigned long pos;
+						_BitScanForward64(&pos, bits);
+						_bittestandreset64((Int64*)&bits, pos);
+						_order[tail++] = (ID)((k << 6) + pos);
+					}
+				}
+
+				std::sort(_order + first, _order + tail, isLess);
+			}
+		}
+
+		std::reverse(_order, _order + n);
+
+		delete[] byDegree;
+		delete[] visited;
+	}
+
+	Ext::BooleanError PackVertices(Ext::Array<Vertex> _graph, Ext::Array<ID> _originalVertexId, VertexOrder _order)
+	{
+		auto n = (decltype(Vertex::Id))_graph.size();
+		if (_originalVertexId.size() < n)
+			return Ext::BooleanError::Error;
+
+		if ((_order == VertexOrder::None) || (n < 2))
+			return Ext::BooleanError::False;
+
+		// order[i] : vertex that gets id i; position : its inverse.
+		ID *order = new ID[2 * (size_t)n + 2];
+		ID *position = order + n + 1;
+		decltype(Vertex::Id) i, j;
+
+		switch (_order)
+		{
+		case VertexOrder::Degeneracy:
+			GetDegeneracyOrder(_graph, Ext::Array<ID>(order, n));
+			break;
+		case VertexOrder::DegreeDescending:
+			for (i = 0; i < n; i++)
+				order[i] = i;
+
+			std::stable_sort(order, order + n, [&_graph](ID _a, ID _b) { return _graph[_a].Count > _graph[_b].Count; });
+			break;
+		case VertexOrder::Bandwidth:
+			GetBandwidthOrder(_graph, order);
+			break;
+		default:
+			delete[] order;
+			return Ext::BooleanError::Error;
+		}
+
+		for (i = 0; (i < n) && (order[i] == i); i++);
+		if (i == n)
+		{
+			delete[] order;
+			return Ext::BooleanError::False;
+		}
+
+		for (i = 0; i < n; i++)
+			position[order[i]] = i;
+
+		size_t qwords = GetQWordSizeForBits(n), rowSize = GetQWordAlignedSizeForBits(n);
+		byte *row = new byte[rowSize];
+
+		// Columns : bit j of each row moves to position[j].
+		for (i = 0; i < n; i++)
+		{
+			auto neighbours = (UInt64*)_graph[i].Neighbours;
+
+			ZeroMemoryPack8(row, rowSize);
+			for (size_t k = 0; k < qwords; k++)
+			{
+				UInt64 bits = neighbours[k];
+				while (bits != 0)
+				{
+					unsigned long pos;
+					_BitScanForward64(&pos, bits);
+					_bittestandreset64((Int64*)&bits, pos);
+					BitSet(row, position[(k << 6) + pos]);
+				}
+			}
+
+			CopyMemoryPack8(neighbours, row, rowSize);
+		}
+
+		// Rows : row i takes row order[i], a cycle of the permutation at a time; position marks the rows placed.
+		for (i = 0; i < n; i++)
+		{
+			if ((position[i] == INVALID_ID) || (order[i] == i))
+				continue;
+
+			CopyMemoryPack8(row, _graph[i].Neighbours, rowSize);
+			auto count = _graph[i].Count;
+			auto originalVertexId = _originalVertexId[i];
+
+			for (j = i; order[j] != i; j = order[j])
+			{
+				CopyMemoryPack8(_graph[j].Neighbours, _graph[order[j]].Neighbours, rowSize);
+				_graph[j].Count = _graph[order[j]].Count;
+				_originalVertexId[j] = _originalVertexId[order[j]];
+				position[j] = INVALID_ID;
+			}
+
+			CopyMemoryPack8(_graph[j].Neighbours, row, rowSize);
+			_graph[j].Count = count;
+			_originalVertexId[j] = originalVertexId;
+			position[j] = INVALID_ID;
+		}
+
+		delete[] row;
+		delete[] order;
+
+		return Ext::BooleanError::True;
+	}
+
+	Ext::Array<Vertex> CreateOrientedGraph(Ext::Array<Vertex> _graph, Ext::Array<ID> _order)
+	{
+		auto n = (decltype(Vertex::Id))_graph.size();
+		ID *position = new ID[n + 1];
+		decltype(Vertex::Id) i, j;
+
+		for (i = 0; i < n; i++)
+			position[_order[i]] = i;
+
+		auto graph = CreateGraph(n);
+		for (i = 0; i < n; i++)
+		{
+			auto src = _graph[_order[i]].Neighbours;
+			auto dest = graph[i].Neighbours;
+
+			for (j = 0; j < n; j++)
+			{
+				if ((position[j] > i) && BitTest(src, j))
+					BitSet(dest, position[j]);
+			}
+
+			graph[i].Count = (decltype(Vertex::Count))PopCount((UInt64*)dest, GetQWordSizeForBits(n));
+		}
+
+		delete[] position;
+
+		return graph;
+	}
+
 }
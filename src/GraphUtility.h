@@ -18,8 +18,10 @@
 #include "graph_types.h"
 #include "Types.h"
 #include "Bit.h"
+#include "MemoryAllocation.h"
 
 #include <time.h>
+#include <string>
 
 namespace Graph
 {
@@ -64,17 +66,11 @@ namespace Graph
 
 #include "Templates.h"
 
-#if (_MSC_VER)
-#define forceinline	__forceinline
-#else
-#define forceinline	__attribute__((always_inline))
-#endif
-
 	class GraphDtor
 	{
 	public:
 		GraphDtor(Ext::Array<Vertex> _graph) : ptr((byte*)_graph.ptr()) { };
-		~GraphDtor() { delete[]ptr; };
+		~GraphDtor() { FreeMemory(ptr); };
 
 	private:
 		byte* ptr;
@@ -124,7 +120,8 @@ namespace Graph
 
 	Ext::Array<Vertex> CreateGraph(size_t _count);
 
-	Ext::Array<Vertex> CreateGraph(size_t _count, void* _ptr);
+	// _zeroNeighbours : false leaves the rows as they are, for callers that write every word of every row.
+	Ext::Array<Vertex> CreateGraph(size_t _count, void* _ptr, bool _zeroNeighbours = true);
 
 	void FreeGraph(Ext::Array<Vertex>& _graph);
 
@@ -155,22 +152,116 @@ namespace Graph
 		}
 	}
 
+#if (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__))
+#define _IS_BIG_ENDIAN_ 1
+#define _byteswap_uint64 __builtin_bswap64
+#elif (defined(_M_IX86) || defined(__i386__) || defined(_M_X64) || defined(__x86_64__) || defined(__x86_64))
+#define _IS_LITTLE_ENDIAN_ 1
+#else
+#undef _IS_LITTLE_ENDIAN_
+#undef _IS_BIG_ENDIAN_
+#endif
+
+	/*
+	*	Word at a time bit iteration : TZCNT gives the lowest set bit of a qword and BLSR clears it, so a bit set is
+	*	walked in one step per qword plus one per set bit rather than one per bit or byte. The bit sets are byte
+	*	addressed (bit i is bit i % 8 of byte i / 8), hence the byte swap of each qword on big endian targets.
+	*/
+	UInt64 forceinline LoadBits64(const void* _ptr)
+	{
+		UInt64 bits;
+		memcpy(&bits, _ptr, sizeof(bits));
+#if defined(_IS_BIG_ENDIAN_)
+		bits = _byteswap_uint64(bits);
+#endif
+		return bits;
+	}
+
+	ID forceinline LowestBit64(UInt64 _bits)
+	{
+		return (ID)_tzcnt_u64(_bits);
+	}
+
+	UInt64 forceinline ResetLowestBit64(UInt64 _bits)
+	{
+		return _blsr_u64(_bits);
+	}
+
+	// Calls _callback(i) for every set bit i of the _size qwords at _p, in increasing order.
+	template <class Callback>
+	void forceinline ForEachBit(const UInt64* _p, size_t _size, Callback _callback)
+	{
+		ID offset = 0;
+		for (const UInt64 *pEnd = _p + _size; (_p < pEnd); _p++, offset += 64)
+		{
+			for (UInt64 bits = LoadBits64(_p); bits != 0; bits = ResetLowestBit64(bits))
+				_callback(offset + LowestBit64(bits));
+		}
+	}
+
+	// Writes the indices of the set bits of the _size qwords at _p to _list, in increasing order; returns their count.
+	ID forceinline GetBitIndices(const UInt64* _p, ID* _list, size_t _size)
+	{
+		ID idx = 0, offset = 0;
+#if defined(__AVX512F__)
+		// VPCOMPRESSD stores the lanes of 16 consecutive indices selected by 16 bits of the word.
+		const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		const __m512i step = _mm512_set1_epi32(16);
+		for (const UInt64 *pEnd = _p + _size; (_p < pEnd); _p++, offset += 64)
+		{
+			UInt64 bits = LoadBits64(_p);
+			if (bits == 0)
+				continue;
+
+			__m512i indices = _mm512_add_epi32(lanes, _mm512_set1_epi32((int)offset));
+			for (; bits != 0; bits >>= 16, indices = _mm512_add_epi32(indices, step))
+			{
+				__mmask16 m = (__mmask16)bits;
+				_mm512_mask_compressstoreu_epi32(_list + idx, m, indices);
+				idx += __popcnt((unsigned int)m);
+			}
+		}
+#else
+		for (const UInt64 *pEnd = _p + _size; (_p < pEnd); _p++, offset += 64)
+		{
+			for (UInt64 bits = LoadBits64(_p); bits != 0; bits = ResetLowestBit64(bits))
+				_list[idx++] = offset + LowestBit64(bits);
+		}
+#endif
+
+		return idx;
+	}
+
+	// Index of the first set bit of the count bytes at _ptr, count << 3 if there is none; _ptr need not be aligned.
 	size_t forceinline FindNextBit(byte* _ptr, size_t count)
 	{
-		byte *ptr = _ptr, *end = _ptr + count;
-		while ((ptr < end) && (*ptr == 0))
-			ptr++;
+		size_t i = 0;
+		for (; (i + sizeof(UInt64)) <= count; i += sizeof(UInt64))
+		{
+			UInt64 bits = LoadBits64(_ptr + i);
+			if (bits != 0)
+				return (i << 3) + LowestBit64(bits);
+		}
 
-		return (ptr < end) ? (((ptr - _ptr) << 3) + _tzcnt_u32(*ptr)) : (count << 3);
+		for (; (i < count) && (_ptr[i] == 0); i++);
+
+		return (i < count) ? ((i << 3) + _tzcnt_u32(_ptr[i])) : (count << 3);
 	}
 
+	// Index of the first reset bit of the count bytes at _ptr, count << 3 if there is none; _ptr need not be aligned.
 	size_t forceinline FindNextBitZero(byte* _ptr, size_t count)
 	{
-		byte *ptr = _ptr, *end = _ptr + count;
-		while ((ptr < end) && (*ptr == 0xFF))
-			ptr++;
+		size_t i = 0;
+		for (; (i + sizeof(UInt64)) <= count; i += sizeof(UInt64))
+		{
+			UInt64 bits = ~LoadBits64(_ptr + i);
+			if (bits != 0)
+				return (i << 3) + LowestBit64(bits);
+		}
+
+		for (; (i < count) && (_ptr[i] == 0xFF); i++);
 
-		return (ptr < end) ? (((ptr - _ptr) << 3) + _tzcnt_u32(~*ptr)) : (count << 3);
+		return (i < count) ? ((i << 3) + _tzcnt_u32((byte)~_ptr[i])) : (count << 3);
 	}
 
 	size_t forceinline FindNextBitZero(byte* _ptr, byte* _activeBits, size_t count)
@@ -290,16 +381,6 @@ namespace Graph
 			*_q = ~(*_p);
 	};
 
-#if (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__))
-#define _IS_BIG_ENDIAN_ 1
-#define _byteswap_uint64 __builtin_bswap64
-#elif (defined(_M_IX86) || defined(__i386__) || defined(_M_X64) || defined(__x86_64__) || defined(__x86_64))
-#define _IS_LITTLE_ENDIAN_ 1
-#else
-#undef _IS_LITTLE_ENDIAN_
-#undef _IS_BIG_ENDIAN_
-#endif
-
 	ID forceinline GetMembers(UInt64* _p, UInt64* _p2, UInt64* _q, ID* _list, size_t _size)
 	{
 		ID idx = 0, offset = 0;
@@ -311,14 +392,8 @@ namespace Graph
 			bits = _byteswap_uint64(bits);
 #endif
 
-			while (bits != 0)
-			{
-				unsigned long pos;
-				// bits Bn.....B0
-				_BitScanForward64(&pos, bits);
-				_bittestandreset64((Int64*)&bits, pos);
-				_list[idx++] = offset + pos;
-			}
+			for (; bits != 0; bits = ResetLowestBit64(bits))
+				_list[idx++] = offset + LowestBit64(bits);
 		}
 
 		return idx;
@@ -328,6 +403,13 @@ namespace Graph
 
 	Ext::Array<Vertex> ReadDIMACSGraph(const char * _binGraphFile);
 
+	// Graph cache : CreateGraph layout of the adjacency rows, mapped read-only into memory.
+	bool SaveGraphCache(const char* _cacheFile, Ext::Array<Vertex> _graph);
+
+	Ext::Array<Vertex> MapGraphCache(const char* _cacheFile);
+
+	void UnmapGraphCache(Ext::Array<Vertex>& _graph);
+
 	SAT::Formula	ReadDIMACSSATFormula(const char * _satFormula);
 
 	void SaveDIMACSGraph(const char* _binGraphFile, Ext::Array<Vertex> _graph, const char* _name = nullptr, byte* _buffer = nullptr);
@@ -351,6 +433,48 @@ namespace Graph
 		return ResizeGraph(_graph, (decltype(Vertex::Id))_graph.size(), _ptr);
 	};
 
+	/*
+	*	Half matrix storage of a symmetric graph, for large graphs that stay resident and are only read (server -triangular).
+	*	Row i keeps its words from i / 64 on, so the 64x64 blocks on the diagonal are whole; the words before are column i
+	*	of the rows above and are rebuilt on demand. Searches stay dense : CloneGraph() gives the dense graph and
+	*	ExtractGraph() a dense subgraph.
+	*/
+	struct TriangularGraph
+	{
+	public:
+		TriangularGraph()
+			: Rows(nullptr, 0)
+		{
+		}
+
+		size_t size() const { return Rows.size(); }
+
+		Ext::Array<Vertex>	Rows;		// Id and Count as in the dense graph; Neighbours from word (i / 64) of row i.
+	};
+
+	size_t GetTriangularGraphAllocationSize(size_t _count);
+
+	// _graph must be symmetric. _ptr : GetTriangularGraphAllocationSize() bytes, or nullptr to allocate (FreeTriangularGraph).
+	TriangularGraph CreateTriangularGraph(Ext::Array<Vertex> _graph, void* _ptr = nullptr);
+
+	void FreeTriangularGraph(TriangularGraph& _graph);
+
+	// Dense row of _vertex into _row (GetQWordAlignedSizeForBits(_graph.size()) bytes); returns _row.
+	byte* GetTriangularGraphRow(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex, byte* _row);
+
+	// As above into the scratch row of the calling thread; valid until the thread's next call.
+	byte* GetTriangularGraphRow(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex);
+
+	// Dense graph in CreateGraph() layout, through 64x64 block transposes.
+	Ext::Array<Vertex> CloneGraph(const TriangularGraph& _graph, void* _ptr = nullptr);
+
+	// As ExtractGraph() of the dense graph.
+	bool ExtractGraph(const TriangularGraph& _from, Ext::Array<Vertex> _to, byte* _mask, byte* _sizeOfBitset);
+
+	bool IsCorrupt(const TriangularGraph& _graph);
+
+	bool IsClique(const TriangularGraph& _graph, decltype(Vertex::Id) *_cliqueMembers, decltype(Vertex::Id) _cliqueSize, byte* _bitset);
+
 	Ext::Array<Vertex> TransformGraph(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _newSize, Ext::Array<decltype(Vertex::Id)> _idMap);
 
 	// _idMap.first should sorted in ASC order.
@@ -358,6 +482,13 @@ namespace Graph
 
 	void ClearVertexEdges(Ext::Array<Vertex> _graph, byte* _vertices);
 
+	// Transposes a 64x64 bit matrix in place : bit c of _block[r] <-> bit r of _block[c] (little endian rows).
+	void TransposeBits64(UInt64* _block);
+
+	// Makes the first _size rows symmetric from their bits k <= j (row j), through 64x64 block transposes.
+	void MirrorLowerTriangle(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _size);
+
+	// Word wise; _complement may be _src. The self edge of each vertex is kept as it is in _src.
 	void ComplementGraph(Ext::Array<Vertex> _src, Ext::Array<Vertex> _complement);
 
 	Ext::Array<Vertex> CombineGraph(Ext::Array<Vertex> _graph, Ext::Array<Vertex> _graph2);
@@ -368,6 +499,12 @@ namespace Graph
 
 	bool ExtractGraph(Ext::Array<Vertex> _from, Ext::Array<Vertex> _to, byte* _mask, byte* _qwSizeOfBitset);
 
+	/*
+	*	Complement of the subgraph of _from on _mask, written straight into _to (of exactly popcount(_mask) vertices) in
+	*	one pass; same as ExtractGraph followed by ComplementGraph. The rows of _to need not be zeroed.
+	*/
+	bool ExtractComplementGraph(Ext::Array<Vertex> _from, Ext::Array<Vertex> _to, byte* _mask, byte* _sizeOfBitset);
+
 	size_t ExtractBits(byte* _from, byte* _to, byte* _mask, byte* _sizeOfBitset, size_t _size);
 
 	size_t ExtractBitsFromComplement(byte* _complementFrom, byte* _to, byte* _mask, byte* _sizeOfBitset, size_t _size);
@@ -383,6 +520,29 @@ namespace Graph
 
 	bool IsValidColoring(Ext::Array<Vertex> _graph, decltype(Vertex::Id) *_vertexColor);
 
+	// Vertices in degeneracy order (minimum degree removed first); returns the degeneracy.
+	decltype(Vertex::Id) GetDegeneracyOrder(Ext::Array<Vertex> _graph, Ext::Array<ID> _order);
+
+	// Orders of PackVertices().
+	enum struct VertexOrder : byte
+	{
+		None = 0,
+		Degeneracy = 1,				// GetDegeneracyOrder(); the densest core gets the last ids.
+		DegreeDescending = 2,
+		Bandwidth = 3,					// reverse Cuthill-McKee : neighbours get nearby ids.
+	};
+
+	/*
+	*	Renumbers the vertices of _graph in place in _order, so that clustered neighbourhoods share the words of a row.
+	*	_originalVertexId[i] is the id vertex i stands for, on input and on output, so results keep mapping back through
+	*	it. VertexOrder::None (default, as for SetVertexOrder() and -order) keeps the order. Returns False when _order
+	*	leaves the graph as it is, Error on invalid arguments.
+	*/
+	Ext::BooleanError PackVertices(Ext::Array<Vertex> _graph, Ext::Array<ID> _originalVertexId, VertexOrder _order = VertexOrder::None);
+
+	// Vertex i of the result is _order[i]; edges are kept from lower to higher position only, self edges are dropped.
+	Ext::Array<Vertex> CreateOrientedGraph(Ext::Array<Vertex> _graph, Ext::Array<ID> _order);
+
 
 	bool GetQualifiedEdges(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _minimumNeighbours, byte *_bitset);
 
@@ -434,6 +594,75 @@ namespace Graph
 			void *ProcessResultContext;
 			void *PreConditionContext;
 		};
+
+		class ResourceManager;
+
+		/*
+		*	Hard limit (bytes) of the memory held by each ResourceManager created afterwards; 0 : unlimited (default).
+		*	At the limit the search evicts cached ancestor graphs, skips the coloring bound and solves subproblems
+		*	through masks on the parent graph instead of copies. Throws when even scratch memory does not fit.
+		*/
+		void SetMemoryBudget(size_t _bytes);
+
+		size_t GetMemoryBudget();
+
+		// Peak memory held by _resourceManager since its creation.
+		size_t GetMemoryHighWater(const ResourceManager& _resourceManager);
+
+		enum struct CounterFormat : byte
+		{
+			Json = 0,
+			Csv = 1,
+		};
+
+		// Breakdown of the search counters by depth for each ResourceManager created afterwards; off by default.
+		void SetCounterDepthBreakdown(bool _enabled);
+
+		/*
+		*	Search counters (name, description, total and per depth values) of the last call made with _resourceManager.
+		*	May be called from a CliqueHandler while the search runs. _label (e.g. graph name) is written with every record.
+		*/
+		std::string ExportCounters(const ResourceManager& _resourceManager, CounterFormat _format, const char* _label = nullptr);
+
+		/*
+		*	Stage timers (time stamp counter) by search depth and histograms of subgraph sizes and branching factors
+		*	for each ResourceManager created afterwards; off by default. Without CliqueProfile this has no effect.
+		*	_samplingInterval : stages are timed in one of every _samplingInterval nodes of a depth (1 : all nodes).
+		*/
+		void SetProfiling(bool _enabled, UInt32 _samplingInterval = 16);
+
+		/*
+		*	FindClique renumbers its copy of the graph by PackVertices() in _order, for each ResourceManager created
+		*	afterwards; VertexOrder::None (default) keeps the order of the graph. Members are reported in the original ids.
+		*/
+		void SetVertexOrder(VertexOrder _order);
+
+		// Summary of the profile of the last call made with _resourceManager; empty when profiling is off.
+		std::string ReportProfile(const ResourceManager& _resourceManager);
+
+		/*
+		*	Estimate of a running FindClique. The explored fraction comes from the top level frames : vertices removed
+		*	from depth 0 so far versus those left, refined by the progress of the depth 1 frame within the current
+		*	depth 0 step, and weighted by the nodes the finished steps took.
+		*/
+		struct Progress
+		{
+			double	Fraction;				// [0, 1]; 1 on the final report.
+			double	ElapsedSeconds;
+			double	EtaSeconds;				// < 0 : unknown yet.
+			UInt64	Nodes;					// TryFindClique calls so far.
+			double	NodesPerSecond;
+			ID			Incumbent;				// size of the largest clique found so far.
+			ID			Depth;					// depth of the search when reported.
+		};
+
+		typedef void(*OnProgress)(const Progress& _progress, void* _context);
+
+		/*
+		*	_handler is called about every _intervalMs during FindClique with _resourceManager, and once at the end.
+		*	nullptr : no reporting (default).
+		*/
+		void SetProgressHandler(ResourceManager& _resourceManager, OnProgress _handler, void* _context, UInt32 _intervalMs);
 	}
 
 	Ext::Array<Vertex> CreateHardPartitionClique(decltype(Vertex::Id) _graphSize, decltype(Vertex::Id) _cliqueSize);
@@ -442,10 +671,187 @@ namespace Graph
 
 	decltype(Vertex::Id) FindClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _cliqueSize = INVALID_ID, Clique::FindOperation _op = Clique::FindOperation::MaximumClique, Clique::CliqueHandler *handler = nullptr);
 
+	// _cliqueMembers : receives the members of the clique found (ascending order); may be empty.
+	decltype(Vertex::Id) FindClique(Ext::Array<Vertex> _graph, Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers, decltype(Vertex::Id) _cliqueSize = INVALID_ID, Clique::FindOperation _op = Clique::FindOperation::MaximumClique, Clique::CliqueHandler *handler = nullptr);
+
+	// Searches a dense copy of _graph, as the dense FindClique searches its clone.
+	decltype(Vertex::Id) FindClique(const TriangularGraph& _graph, Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers, decltype(Vertex::Id) _cliqueSize = INVALID_ID, Clique::FindOperation _op = Clique::FindOperation::MaximumClique, Clique::CliqueHandler *handler = nullptr);
+
+	// Maximum clique containing _vertex. With _cliqueSize (>= 3) only a clique of at least _cliqueSize is searched; returns 0 when none exists.
+	decltype(Vertex::Id) FindVertexClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _vertex, Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers, decltype(Vertex::Id) _cliqueSize = INVALID_ID);
+
+	decltype(Vertex::Id) FindVertexClique(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex, Clique::ResourceManager& _resourceManager, Ext::Array<ID> _cliqueMembers, decltype(Vertex::Id) _cliqueSize = INVALID_ID);
+
 	decltype(Vertex::Id) GetIndependentSets(Ext::Array<Vertex> _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize = 0);
 
-	bool Solve(SAT::Formula _formula);
+	decltype(Vertex::Id) GetIndependentSets(Ext::Array<Vertex> _graph, Clique::ResourceManager& _resourceManager, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize = 0);
+
+	decltype(Vertex::Id) GetIndependentSets(const TriangularGraph& _graph, Clique::ResourceManager& _resourceManager, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize = 0);
+
+	/*
+	*	Coloring engines; the outputs are those of GetIndependentSets (colors one based, one set per color in _pSets).
+	*	Exact is GetIndependentSets; the heuristics read the rows as they are and suit graphs too large for it.
+	*/
+	enum struct ColoringMode : byte
+	{
+		Exact = 0,
+		DSatur = 1,					// saturation degree order (Brelaz); O(n^2).
+		RecursiveLargestFirst = 2,	// a maximal independent set at a time (Leighton); fewer colors, O(n^3 / 64) worst case.
+		JonesPlassmann = 3			// parallel rounds over random priorities of _seed; the same colors for any _threads.
+	};
+
+	// _tabuIterations > 0 : the heuristic coloring is then reduced a color at a time by a tabu search of up to that many moves each.
+	// _threads == 0 : number of hardware threads.
+	// _timeLimitMs > 0 : the tabu search stops that long after the call, with the best coloring reached.
+	decltype(Vertex::Id) GetColoring(Ext::Array<Vertex> _graph, ColoringMode _mode, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, UInt32 _tabuIterations = 0, UInt32 _threads = 0, UInt64 _seed = 0, UInt32 _timeLimitMs = 0);
+
+	// Appends one set per color 1.._colors of _vertexColor to _sets, members ascending.
+	void GetColorClasses(const ID* _vertexColor, decltype(Vertex::Id) _size, decltype(Vertex::Id) _colors, Ext::ArrayOfArray<Graph::ID, Graph::ID>& _sets);
+
+	// Called with each better coloring GetChromaticNumber finds (the first is the heuristic one); return true to continue, false to stop.
+	typedef bool(*OnColoring)(ID _colors, ID _lowerBound, const ID* _vertexColor, void* _context);
+
+	/*
+	*	Chromatic number by DSATUR branch and bound. The maximum clique (FindClique) is the lower bound and is
+	*	colored first; DSATUR with tabu gives the first upper bound. The search then looks for colorings of fewer
+	*	colors until it proves the best one optimal, _timeLimitMs passes or _handler stops it. The time limit (0 : none)
+	*	covers all three stages : the tabu search and the clique search stop at it with the best coloring and the
+	*	largest clique found so far, and the branch and bound is not started. Returns the colors of the best coloring
+	*	found, written to _vertexColor and _pSets as GetIndependentSets does; *_pLowerBound is then the proven lower
+	*	bound, equal to the result when it is χ(_graph).
+	*/
+	decltype(Vertex::Id) GetChromaticNumber(Ext::Array<Vertex> _graph, Clique::ResourceManager& _resourceManager, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, ID* _pLowerBound, UInt32 _timeLimitMs = 0, OnColoring _handler = nullptr, void* _context = nullptr);
+
+	namespace Clique
+	{
+		/*
+		*	Owns the ResourceManager (call frames, memory pools and scratch buffers) across calls.
+		*	Buffers grow only when a larger graph arrives; counters are reset on every call.
+		*	An instance must not be shared by concurrent calls.
+		*/
+		class Solver
+		{
+		public:
+			Solver(decltype(Vertex::Id) _capacity = 0);
+			~Solver();
+
+			// Ensures buffers for graphs of up to _graphSize vertices.
+			void Reserve(decltype(Vertex::Id) _graphSize);
+
+			decltype(Vertex::Id) FindClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _cliqueSize = INVALID_ID, FindOperation _op = FindOperation::MaximumClique, CliqueHandler *_handler = nullptr);
+
+			decltype(Vertex::Id) FindVertexClique(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _vertex, decltype(Vertex::Id) _cliqueSize = INVALID_ID);
+
+			decltype(Vertex::Id) GetIndependentSets(Ext::Array<Vertex> _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize = 0);
+
+			// Half matrix graphs (see TriangularGraph); the search runs on a dense copy held by the call.
+			decltype(Vertex::Id) FindClique(const TriangularGraph& _graph, decltype(Vertex::Id) _cliqueSize = INVALID_ID, FindOperation _op = FindOperation::MaximumClique, CliqueHandler *_handler = nullptr);
+
+			decltype(Vertex::Id) FindVertexClique(const TriangularGraph& _graph, decltype(Vertex::Id) _vertex, decltype(Vertex::Id) _cliqueSize = INVALID_ID);
+
+			decltype(Vertex::Id) GetIndependentSets(const TriangularGraph& _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, decltype(Vertex::Id) _cliqueSize = 0);
+
+			// See Graph::GetColoring(); the heuristics color a half matrix graph on a dense copy.
+			decltype(Vertex::Id) GetColoring(Ext::Array<Vertex> _graph, ColoringMode _mode, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, UInt32 _tabuIterations = 0, UInt32 _threads = 0, UInt64 _seed = 0);
 
-	Ext::BooleanError PackVertices(Ext::Array<Vertex> _graph);
+			decltype(Vertex::Id) GetColoring(const TriangularGraph& _graph, ColoringMode _mode, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, UInt32 _tabuIterations = 0, UInt32 _threads = 0, UInt64 _seed = 0);
+
+			// See Graph::GetChromaticNumber(); a half matrix graph is solved on a dense copy.
+			decltype(Vertex::Id) GetChromaticNumber(Ext::Array<Vertex> _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, ID* _pLowerBound, UInt32 _timeLimitMs = 0, OnColoring _handler = nullptr, void* _context = nullptr);
+
+			decltype(Vertex::Id) GetChromaticNumber(const TriangularGraph& _graph, Ext::ArrayOfArray<Graph::ID, Graph::ID> *_pSets, Ext::Array<ID> _vertexColor, ID* _pLowerBound, UInt32 _timeLimitMs = 0, OnColoring _handler = nullptr, void* _context = nullptr);
+
+			// Members (ascending order) of the clique found by the last FindClique / FindVertexClique.
+			Ext::Array<ID> CliqueMembers() { return Ext::Array<ID>(Members, CliqueSize); }
+
+			decltype(Vertex::Id) Capacity() const { return CapacityValue; }
+
+			// Number of TryFindClique invocations made by the last call.
+			UInt64 Calls() const;
+
+			// Peak memory held by the solver's pools and call frames.
+			size_t MemoryHighWater() const;
+
+			// Search counters of the last call; see Clique::ExportCounters().
+			std::string ExportCounters(CounterFormat _format, const char* _label = nullptr) const;
+
+			// Profile of the last call; see Clique::SetProfiling().
+			std::string ReportProfile() const;
+
+			// Progress of FindClique; see Clique::SetProgressHandler().
+			void SetProgressHandler(OnProgress _handler, void* _context, UInt32 _intervalMs);
+
+			// Prints statistics of each call through TraceMessage.
+			void SetTraceStatistics(bool _traceStatistics);
+
+		private:
+			Solver(const Solver&) = delete;
+			Solver& operator=(const Solver&) = delete;
+
+			void DiscardResources();
+
+		private:
+			ResourceManager			*Resources;
+			ID							*Members;
+			decltype(Vertex::Id)	CliqueSize;
+			decltype(Vertex::Id)	CapacityValue;
+			bool						TraceStatistics;
+
+			OnProgress				ProgressHandler;
+			void						*ProgressContext;
+			UInt32					ProgressInterval;
+		};
+	}
+
+	namespace Clique
+	{
+		// 128 bit counter; 64 bit partial counts are accumulated with carry.
+		struct CliqueCount
+		{
+		public:
+			CliqueCount()
+				: Low(0), High(0)
+			{
+			}
+
+			void Add(UInt64 _value)
+			{
+				Low += _value;
+				High += (Low < _value) ? 1 : 0;
+			}
+
+			void Add(const CliqueCount& _value)
+			{
+				Add(_value.Low);
+				High += _value.High;
+			}
+
+			double ToDouble() const { return (double)High * 18446744073709551616.0 + (double)Low; }
+
+		public:
+			UInt64 Low, High;
+		};
+	}
+
+	namespace Clique
+	{
+		// Members are original vertex ids, valid during the call only. Return true to continue; false to stop.
+		// Invoked concurrently from the enumeration threads.
+		typedef bool(*OnMaximalClique)(const ID* _members, ID _size, void* _context);
+	}
+
+	// Enumerates maximal cliques of at least _minimumSize vertices; returns the number reported.
+	UInt64 EnumerateMaximalCliques(Ext::Array<Vertex> _graph, Clique::OnMaximalClique _handler, void* _context, decltype(Vertex::Id) _minimumSize = 1, UInt32 _threads = 0);
+
+	// Number of cliques of _k vertices. _threads == 0 : number of hardware threads.
+	Clique::CliqueCount CountCliques(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _k, UInt32 _threads = 0);
+
+	// Estimated number of cliques of _k vertices from _samples outer vertices drawn uniformly (reproducible for _seed).
+	double EstimateCliques(Ext::Array<Vertex> _graph, decltype(Vertex::Id) _k, UInt32 _samples, UInt64 _seed = 0, UInt32 _threads = 0);
+
+	// _cliqueNumbers[v] : size of the maximum clique containing v. _threads == 0 : number of hardware threads.
+	void GetLocalCliqueNumbers(Ext::Array<Vertex> _graph, Ext::Array<ID> _cliqueNumbers, UInt32 _threads = 0);
+
+	bool Solve(SAT::Formula _formula);
 }
 #endif
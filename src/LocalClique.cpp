@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "GraphUtility.h"
+#include "Templates.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace Graph
+{
+	//	Raises _bound to _value; returns true when _bound was raised.
+	static bool RaiseLowerBound(std::atomic<ID>& _bound, ID _value)
+	{
+		ID current = _bound.load();
+		while (current < _value)
+		{
+			if (_bound.compare_exchange_weak(current, _value))
+				return true;
+		}
+
+		return false;
+	}
+
+	//	A clique is a lower bound of the local clique number of each of its members.
+	static void ShareClique(Ext::Array<ID> _members, std::atomic<ID>* _lowerBound)
+	{
+		for (ID i = 0; i < _members.size(); i++)
+			RaiseLowerBound(_lowerBound[_members[i]], (ID)_members.size());
+	}
+
+	/*
+	*	ω(v) : size of the maximum clique containing v, for every vertex v.
+	*
+	*	1. The search for v is restricted to N[v] (FindVertexClique).
+	*	2. Every clique found for v is a lower bound of ω(u) for each of its members u. Bounds are shared
+	*		between threads, so a later search for u first checks (ExactSearch) for a clique larger than the bound.
+	*	3. ω(v) <= degree(v) + 1; a vertex whose bound reaches it is not searched.
+	*	4. Vertices are processed in parallel, biggest degree first.
+	*/
+	void GetLocalCliqueNumbers(Ext::Array<Vertex> _graph, Ext::Array<ID> _cliqueNumbers, UInt32 _threads)
+	{
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
+
+		if (_cliqueNumbers.size() < _graph.size())
+			throw "invalid _cliqueNumbers.";
+
+		auto n = (decltype(Vertex::Id))_graph.size();
+		std::unique_ptr<std::atomic<ID>[]> lowerBound(new std::atomic<ID>[n + 1]);
+		std::vector<ID> degree(n), order(n);
+
+		for (decltype(Vertex::Id) i = 0; i < n; i++)
+		{
+			degree[i] = _graph[i].Count - (BitTest(_graph[i].Neighbours, i) ? 1 : 0);
+			order[i] = i;
+			lowerBound[i] = (degree[i] > 0) ? 2 : 1;
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](ID a, ID b) { return degree[a] > degree[b]; });
+
+		auto threads = Parallel::GetThreadCount(_threads);
+		std::vector<std::unique_ptr<Clique::Solver>> solvers(threads);
+
+		Parallel::For(n, threads, [&](UInt32 _threadIndex, size_t _item)
+		{
+			auto v = order[_item];
+
+			if ((degree[v] <= 1) || (lowerBound[v] >= degree[v] + 1))
+				return;
+
+			if (solvers[_threadIndex] == nullptr)
+				solvers[_threadIndex].reset(new Clique::Solver(n));
+
+			auto& solver = *solvers[_threadIndex];
+
+			// A shared bound (>= 3) is first checked by ExactSearch for a larger clique; only then is the maximum clique searched.
+			ID bound = lowerBound[v];
+			if (bound >= 3)
+			{
+				auto cliqueSize = solver.FindVertexClique(_graph, v, bound + 1);
+				if ((cliqueSize == INVALID_ID) || (cliqueSize <= bound))
+					return;
+
+				ShareClique(solver.CliqueMembers(), lowerBound.get());
+			}
+
+			auto cliqueSize = solver.FindVertexClique(_graph, v);
+			if (cliqueSize == INVALID_ID)
+				throw "unable to find clique.";
+
+			ShareClique(solver.CliqueMembers(), lowerBound.get());
+			RaiseLowerBound(lowerBound[v], cliqueSize);
+		});
+
+		for (decltype(Vertex::Id) i = 0; i < n; i++)
+			_cliqueNumbers[i] = lowerBound[i];
+	}
+}
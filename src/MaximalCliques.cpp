@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "GraphUtility.h"
+#include "Parallel.h"
+
+#include <atomic>
+#include <vector>
+
+namespace Graph
+{
+	namespace Clique
+	{
+		struct MaximalCliqueContext
+		{
+			MaximalCliqueContext()
+				: Order(nullptr), QWords(0), MinimumSize(0), Handler(nullptr), HandlerContext(nullptr), IsStopped(nullptr),
+				R(nullptr), Members(nullptr), Candidates(nullptr), Sets(nullptr), Count(0)
+			{
+			}
+
+			Ext::Array<Vertex>	Graph;				// relabeled in degeneracy order, no self edges.
+			ID						*Order;				// original vertex id by position.
+			size_t					QWords;
+			ID						MinimumSize;
+			OnMaximalClique		Handler;
+			void						*HandlerContext;
+			std::atomic<bool>		*IsStopped;
+
+			// per thread
+			ID						*R, *Members, *Candidates;
+			UInt64					*Sets;
+			UInt64					Count;
+		};
+
+		/*
+		*	Bron–Kerbosch with pivot. _p : candidates, _x : excluded; both of _context.QWords.
+		*	Level _depth + 1 sets are at _p + 2 * QWords; candidate list of level _depth at Candidates + _depth * (n + 1).
+		*/
+		static void ExpandMaximalClique(MaximalCliqueContext& _context, ID _depth, UInt64* _p, UInt64* _x)
+		{
+			auto qwords = _context.QWords;
+			auto pCount = (ID)PopCount(_p, qwords);
+
+			if (pCount == 0)
+			{
+				if ((PopCount(_x, qwords) == 0) && (_depth >= _context.MinimumSize))
+				{
+					for (ID i = 0; i < _depth; i++)
+						_context.Members[i] = _context.Order[_context.R[i]];
+
+					_context.Count++;
+					if ((_context.Handler != nullptr) && !_context.Handler(_context.Members, _depth, _context.HandlerContext))
+						*_context.IsStopped = true;
+				}
+
+				return;
+			}
+
+			if (_depth + pCount < _context.MinimumSize)
+				return;
+
+			// pivot : vertex of P ∪ X with most neighbours in P.
+			size_t best = 0, bestCount = 0;
+			for (size_t k = 0; k < qwords; k++)
+			{
+				UInt64 bits = _p[k] | _x[k];
+				while (bits != 0)
+				{
+					unsigned long pos;
+					_BitScanForward64(&pos, bits);
+					_bittestandreset64((Int64*)&bits, pos);
+
+					size_t u = (k << 6) + pos;
+					auto count = PopCountAandB(_p, (UInt64*)_context.Graph[u].Neighbours, qwords);
+					if ((count > bestCount) || (bestCount == 0))
+					{
+						best = u;
+						bestCount = count;
+					}
+				}
+			}
+
+			auto candidates = _context.Candidates + _depth * (_context.Graph.size() + 1);
+			auto count = GetMembers(_p, _p, (UInt64*)_context.Graph[best].Neighbours, candidates, qwords);
+			auto p = _p + 2 * qwords;
+			auto x = p + qwords;
+
+			for (ID i = 0; (i < count) && !*_context.IsStopped; i++)
+			{
+				auto w = candidates[i];
+				auto neighbours = (UInt64*)_context.Graph[w].Neighbours;
+
+				_context.R[_depth] = w;
+				AandB(_p, neighbours, p, qwords);
+				AandB(_x, neighbours, x, qwords);
+
+				ExpandMaximalClique(_context, _depth + 1, p, x);
+
+				BitReset((byte*)_p, w);
+				BitSet(((byte*)_x), w);
+			}
+		}
+	}
+
+	UInt64 EnumerateMaximalCliques(Ext::Array<Vertex> _graph, Clique::OnMaximalClique _handler, void* _context, decltype(Vertex::Id) _minimumSize, UInt32 _threads)
+	{
+		if (IsCorrupt(_graph))
+			throw "invalid _graph.";
+
+		auto n = (decltype(Vertex::Id))_graph.size();
+		if (n == 0)
+			return 0;
+
+		std::vector<ID> order(n), position(n);
+		auto degeneracy = GetDegeneracyOrder(_graph, Ext::Array<ID>(order.data(), n));
+
+		for (decltype(Vertex::Id) i = 0; i < n; i++)
+			position[order[i]] = i;
+
+		// Relabel by position, without self edges.
+		auto graph = CreateGraph(n);
+		GraphDtor dtor(graph);
+		decltype(Vertex::Id) i, j;
+
+		for (i = 0; i < n; i++)
+		{
+			auto src = _graph[order[i]].Neighbours;
+			for (j = 0; j < n; j++)
+			{
+				if ((j != order[i]) && BitTest(src, j))
+					BitSet(graph[i].Neighbours, position[j]);
+			}
+
+			graph[i].Count = (decltype(Vertex::Count))PopCount((UInt64*)graph[i].Neighbours, GetQWordSizeForBits(n));
+		}
+
+		//	Outer vertex i : P = later neighbours (at most degeneracy), X = earlier neighbours; depth <= degeneracy + 1.
+		auto threads = Parallel::GetThreadCount(_threads);
+		size_t qwords = GetQWordSizeForBits(n);
+		size_t levels = (size_t)degeneracy + 2;
+		std::atomic<bool> isStopped(false);
+		std::vector<Clique::MaximalCliqueContext> contexts(threads);
+		std::vector<std::vector<UInt64>> sets(threads);
+		std::vector<std::vector<ID>> lists(threads);
+
+		Parallel::For(n, threads, [&](UInt32 _threadIndex, size_t _item)
+		{
+			if (isStopped)
+				return;
+
+			auto& context = contexts[_threadIndex];
+			if (sets[_threadIndex].size() == 0)
+			{
+				sets[_threadIndex].resize(2 * qwords * (levels + 1));
+				lists[_threadIndex].resize((n + 1) * (levels + 2) + 2 * levels);
+
+				context.Graph = graph;
+				context.Order = order.data();
+				context.QWords = qwords;
+				context.MinimumSize = _minimumSize;
+				context.Handler = _handler;
+				context.HandlerContext = _context;
+				context.IsStopped = &isStopped;
+				context.Sets = sets[_threadIndex].data();
+				context.R = lists[_threadIndex].data();
+				context.Members = context.R + levels;
+				context.Candidates = context.Members + levels;
+			}
+
+			auto v = (ID)_item;
+			auto p = context.Sets;
+			auto x = p + qwords;
+			auto neighbours = (byte*)graph[v].Neighbours;
+
+			ZeroMemoryPack8(p, qwords * 2 * sizeof(UInt64));
+			for (ID u = 0; u < n; u++)
+			{
+				if (!BitTest(neighbours, u))
+					continue;
+
+				if (u > v)
+					BitSet(((byte*)p), u);
+				else
+					BitSet(((byte*)x), u);
+			}
+
+			context.R[0] = v;
+			ExpandMaximalClique(context, 1, p, x);
+		});
+
+		UInt64 count = 0;
+		for (auto& context : contexts)
+			count += context.Count;
+
+		return count;
+	}
+}
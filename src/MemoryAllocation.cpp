@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "MemoryAllocation.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+	const size_t LargePageSize = 2 * 1024 * 1024;
+	const size_t HeaderSize = 64;		// keeps the returned memory cache line aligned; heap blocks are allocated 64 byte aligned.
+
+	//	Precedes every allocation; FreeMemory() releases through the backend recorded here.
+	struct AllocationHeader
+	{
+		void*		Base;
+		size_t	Size;				// size of the mapping at Base.
+		AllocationBackend	Backend;
+		bool		IsLocked;
+	};
+
+	AllocationOptions	Options;
+	std::atomic<UInt64>	Allocations[4];
+	std::atomic<UInt64>	LargeAllocations(0);
+	std::atomic<UInt64>	LockFailures(0);
+	std::atomic<byte>		LastBackend((byte)AllocationBackend::Heap);
+
+	std::once_flag	InitializeFlag;
+
+	bool ParseAllocationOptions(const char* _text, AllocationOptions& _options)
+	{
+		char buffer[64];
+		char* context = nullptr;
+
+		if ((_text == nullptr) || (strlen(_text) >= sizeof(buffer)))
+			return false;
+
+		strcpy_s(buffer, sizeof(buffer), _text);
+		_options.Lock = false;
+
+		for (char* token = strtok_s(buffer, ",", &context); token != nullptr; token = strtok_s(nullptr, ",", &context))
+		{
+			if (strcmp(token, "heap") == 0)
+				_options.Backend = AllocationBackend::Heap;
+			else if (strcmp(token, "aligned") == 0)
+				_options.Backend = AllocationBackend::Aligned;
+			else if (strcmp(token, "thp") == 0)
+				_options.Backend = AllocationBackend::TransparentHugePages;
+			else if (strcmp(token, "hugetlb") == 0)
+				_options.Backend = AllocationBackend::HugePages;
+			else if (strcmp(token, "lock") == 0)
+				_options.Lock = true;
+			else if (strncmp(token, "min=", 4) == 0)
+				_options.MinimumSize = (size_t)strtoull(token + 4, nullptr, 10);
+			else
+				return false;
+		}
+
+		return true;
+	}
+
+	// CLIQUE_ALLOCATOR environment variable selects the backend when SetAllocationOptions() is not called.
+	// Runs once, also when the first allocations are made concurrently.
+	void Initialize()
+	{
+		std::call_once(InitializeFlag, []()
+		{
+			AllocationOptions options;
+			auto text = getenv("CLIQUE_ALLOCATOR");
+
+			if ((text != nullptr) && ParseAllocationOptions(text, options))
+				Options = options;
+		});
+	}
+
+	size_t GetAlignedSize(size_t _size, size_t _alignment)
+	{
+		return (_size + _alignment - 1) & ~(_alignment - 1);
+	}
+
+#ifdef _WIN32
+	void* MapMemory(size_t& _size, AllocationBackend& _backend)
+	{
+		if (_backend == AllocationBackend::HugePages)
+		{
+			auto largePage = GetLargePageMinimum();
+			void* ptr = nullptr;
+
+			// requires SeLockMemoryPrivilege; large pages are always locked.
+			if (largePage > 0)
+				ptr = VirtualAlloc(nullptr, GetAlignedSize(_size, largePage), MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+			if (ptr != nullptr)
+			{
+				_size = GetAlignedSize(_size, largePage);
+				return ptr;
+			}
+		}
+
+		// no transparent huge pages on Windows.
+		_backend = AllocationBackend::Aligned;
+		return VirtualAlloc(nullptr, _size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);	// 64 KB granularity.
+	}
+
+	void UnmapMemory(void* _ptr, size_t)
+	{
+		VirtualFree(_ptr, 0, MEM_RELEASE);
+	}
+
+	bool LockMemory(void* _ptr, size_t _size)
+	{
+		return VirtualLock(_ptr, _size) != FALSE;
+	}
+#else
+	void* MapMemory(size_t& _size, AllocationBackend& _backend)
+	{
+		void* ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+		if (_backend == AllocationBackend::HugePages)
+		{
+			ptr = mmap(nullptr, GetAlignedSize(_size, LargePageSize), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (ptr != MAP_FAILED)
+			{
+				_size = GetAlignedSize(_size, LargePageSize);
+				return ptr;
+			}
+
+			_backend = AllocationBackend::TransparentHugePages;
+		}
+#else
+		if (_backend == AllocationBackend::HugePages)
+			_backend = AllocationBackend::TransparentHugePages;
+#endif
+
+		//	2 MB aligned : over-map by one large page and trim both ends.
+		size_t size = GetAlignedSize(_size, LargePageSize);
+		byte* base = (byte*)mmap(nullptr, size + LargePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (base == (byte*)MAP_FAILED)
+			return nullptr;
+
+		byte* aligned = (byte*)GetAlignedSize((size_t)base, LargePageSize);
+		if (aligned > base)
+			munmap(base, aligned - base);
+
+		if ((base + size + LargePageSize) > (aligned + size))
+			munmap(aligned + size, (base + size + LargePageSize) - (aligned + size));
+
+		_size = size;
+
+#ifdef MADV_HUGEPAGE
+		if ((_backend == AllocationBackend::TransparentHugePages) && (madvise(aligned, size, MADV_HUGEPAGE) == 0))
+			return aligned;
+#endif
+
+		_backend = AllocationBackend::Aligned;
+		return aligned;
+	}
+
+	void UnmapMemory(void* _ptr, size_t _size)
+	{
+		munmap(_ptr, _size);
+	}
+
+	bool LockMemory(void* _ptr, size_t _size)
+	{
+		return mlock(_ptr, _size) == 0;
+	}
+#endif
+}
+
+void SetAllocationOptions(const AllocationOptions& _options)
+{
+	std::call_once(InitializeFlag, []() {});		// explicit options take precedence over CLIQUE_ALLOCATOR.
+	Options = _options;
+}
+
+bool SetAllocationOptions(const char* _text)
+{
+	std::call_once(InitializeFlag, []() {});
+
+	AllocationOptions options = Options;
+	if (!ParseAllocationOptions(_text, options))
+		return false;
+
+	SetAllocationOptions(options);
+	return true;
+}
+
+AllocationOptions GetAllocationOptions()
+{
+	Initialize();
+	return Options;
+}
+
+AllocationStatistics GetAllocationStatistics()
+{
+	AllocationStatistics statistics;
+
+	for (int i = 0; i < 4; i++)
+		statistics.Allocations[i] = Allocations[i];
+
+	statistics.LargeAllocations = LargeAllocations;
+	statistics.LockFailures = LockFailures;
+	statistics.LastBackend = (AllocationBackend)LastBackend.load();
+
+	return statistics;
+}
+
+const char* GetAllocationBackendName(AllocationBackend _backend)
+{
+	switch (_backend)
+	{
+	case AllocationBackend::Aligned:
+		return "aligned";
+	case AllocationBackend::TransparentHugePages:
+		return "thp";
+	case AllocationBackend::HugePages:
+		return "hugetlb";
+	default:
+		return "heap";
+	}
+}
+
+void* AllocMemory(size_t size)
+{
+	Initialize();
+
+	AllocationBackend backend = ((Options.Backend == AllocationBackend::Heap) || (size < Options.MinimumSize)) ? AllocationBackend::Heap : Options.Backend;
+	size_t mappedSize = size + HeaderSize;
+	byte* base = nullptr;
+
+	if (backend != AllocationBackend::Heap)
+	{
+		base = (byte*)MapMemory(mappedSize, backend);
+		if (base == nullptr)
+			backend = AllocationBackend::Heap;
+	}
+
+	if (base == nullptr)
+	{
+		mappedSize = size + HeaderSize;
+		base = (byte*)::operator new[](mappedSize, std::align_val_t(HeaderSize));
+	}
+
+	auto header = (AllocationHeader*)base;
+	header->Base = base;
+	header->Size = mappedSize;
+	header->Backend = backend;
+	header->IsLocked = false;
+
+	if (Options.Lock && (size >= Options.MinimumSize))
+	{
+		header->IsLocked = LockMemory(base, mappedSize);
+		if (!header->IsLocked)
+			LockFailures++;
+	}
+
+	Allocations[(int)backend]++;
+	if (size >= Options.MinimumSize)
+	{
+		LargeAllocations++;
+		LastBackend = (byte)backend;
+	}
+
+	return base + HeaderSize;
+}
+
+void FreeMemory(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	auto header = (AllocationHeader*)(((byte*)ptr) - HeaderSize);
+	auto base = header->Base;
+	auto size = header->Size;
+
+#ifndef _WIN32
+	if (header->IsLocked)
+		munlock(base, size);
+#endif
+
+	if (header->Backend == AllocationBackend::Heap)
+		::operator delete[](base, std::align_val_t(HeaderSize));
+	else
+		UnmapMemory(base, size);
+}
@@ -13,16 +13,58 @@
 
 #pragma once
 
-inline void* AllocMemory(size_t size)
+#if (!MemoryAllocation_H)
+#define MemoryAllocation_H
+
+#include "Types.h"
+
+/*
+*	Backend of AllocMemory() for allocations of at least AllocationOptions::MinimumSize bytes;
+*	smaller allocations always come from the heap. Each backend falls back to the next one:
+*		HugePages (MAP_HUGETLB / MEM_LARGE_PAGES)  ->  TransparentHugePages (2 MB aligned, MADV_HUGEPAGE)  ->  Aligned (2 MB aligned)  ->  Heap
+*/
+enum struct AllocationBackend : byte
 {
-	// This function needs to allocate memory using OS Memory allocation API
-	// Make sure that the memory is pinned in RAM and no swapping.
-	return new byte[size];
-}
+	Heap = 0,
+	Aligned = 1,
+	TransparentHugePages = 2,
+	HugePages = 3,
+};
 
-inline void FreeMemory(void* ptr)
+struct AllocationOptions
 {
-	if (ptr != nullptr)
-		delete[](byte*)ptr;
-}
+	AllocationOptions()
+		: Backend(AllocationBackend::Heap), Lock(false), MinimumSize(256 * 1024)
+	{
+	}
+
+	AllocationBackend	Backend;
+	bool					Lock;				// mlock / VirtualLock : pinned in RAM, never swapped.
+	size_t				MinimumSize;
+};
+
+struct AllocationStatistics
+{
+	UInt64	Allocations[4];				// by backend obtained.
+	UInt64	LargeAllocations;			// of at least MinimumSize.
+	UInt64	LockFailures;
+	AllocationBackend	LastBackend;		// backend obtained by the last allocation of at least MinimumSize.
+};
+
+// Not thread safe; to be called before solver memory is allocated.
+void SetAllocationOptions(const AllocationOptions& _options);
+
+// Parses "heap|aligned|thp|hugetlb[,lock][,min=<bytes>]"; returns false on unknown text.
+bool SetAllocationOptions(const char* _text);
+
+AllocationOptions GetAllocationOptions();
+
+AllocationStatistics GetAllocationStatistics();
+
+const char* GetAllocationBackendName(AllocationBackend _backend);
+
+void* AllocMemory(size_t size);
+
+void FreeMemory(void* ptr);
 
+#endif
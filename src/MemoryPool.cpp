@@ -64,16 +64,24 @@ namespace Graph
 
 	typedef HeapBlock<StackMemoryPool::SizeT> _HeapBlock;
 
+	//	Precedes every allocation (AlignmentSize bytes); Block makes Free independent of the number of blocks.
+	struct AllocationHeader
+	{
+		UInt32	Block;
+		UInt32	Reserved;
+		UInt64	Size;
+	};
+
 	///
 	///	BlockForNextAlloc: This will track the block where last alloc or free op took place.
 	///
 
 #define AlignmentSize 16
 
-	StackMemoryPool::StackMemoryPool(SizeT _blockSize, SizeT _maxPoolSize)
+	StackMemoryPool::StackMemoryPool(SizeT _blockSize, SizeT _maxPoolSize, MemoryBudget* _budget)
 		: Pool(nullptr, 0, 0), BlockSize(_blockSize), 
 		  MaxPoolSize((_blockSize <= _maxPoolSize) ? _maxPoolSize : _blockSize),
-		 BlockForNextAlloc(0)
+		 BlockForNextAlloc(0), Budget(_budget)
 #ifdef  TrackAllocations
 		, AllocationPtr(new void*[1000], 1000)
 #endif //  TrackAllocations
@@ -90,10 +98,10 @@ namespace Graph
 		auto pool = Pool.ptr<_HeapBlock>();
 
 		if ((Pool.size() < Pool.capacity()) && (pool[Pool.size()].Ptr != nullptr))
-			FreeMemory(((byte*)pool[Pool.size()].Ptr) - pool[Pool.size()].AlignmentGap);
+			FreeBlock(&pool[Pool.size()]);
 
 		for (size_t i = 0; i < Pool.size(); i++)
-			FreeMemory(((byte*)pool[i].Ptr) - pool[i].AlignmentGap);
+			FreeBlock(&pool[i]);
 
 		delete[]	pool;
 		Pool = Ext::VList<SizeT>(nullptr, 0, 0);
@@ -116,20 +124,24 @@ namespace Graph
 		_size += AlignmentSize;
 		if ((0 == Pool.size()) || (pool[idx].FreeBlockOffset == pool[idx].Capacity) || (pool[idx].FirstFreeBlockSize < _size))
 		{
-			decltype(idx) i;
-			for (i = 0; (i < Pool.size()) && (pool[++idx % Pool.size()].FirstFreeBlockSize < _size); i++);
-			if (i == Pool.size())
+			//	Constant time fit check : the top block, else a new block. All blocks are scanned only when the pool is at MaxPoolSize.
+			idx = Pool.size() - 1;
+			if ((0 == Pool.size()) || (pool[idx].FirstFreeBlockSize < _size))
 			{
-				if (Pool.size() < (MaxPoolSize / BlockSize))
+				void* added = nullptr;
+				if ((Pool.size() < (MaxPoolSize / BlockSize)) && ((added = AddBlock(BlockSize + AlignmentSize * 8 /*for sub-block size header*/)) != nullptr))
 				{
-					pool = (decltype(pool))AddBlock(BlockSize + AlignmentSize * 8 /*for sub-block size header*/);
+					pool = (decltype(pool))added;
 					idx = BlockForNextAlloc;
 				}
 				else
-					return nullptr;
+				{
+					// At MaxPoolSize or out of budget.
+					for (idx = 0; (idx < Pool.size()) && (pool[idx].FirstFreeBlockSize < _size); idx++);
+					if (idx == Pool.size())
+						return nullptr;
+				}
 			}
-			else
-				idx %= Pool.size();
 		}
 
 		_HeapBlock& heap = pool[idx];
@@ -155,8 +167,11 @@ namespace Graph
 			*heap.getFreeBlock() = freeBlock;
 		}
 
-		// set allocated size in allocation header
-		((size_t*)ptr)[-1] = _size - AlignmentSize;
+		// set allocated size and owning block in allocation header
+		auto header = ((AllocationHeader*)ptr) - 1;
+		header->Block = idx;
+		header->Size = _size - AlignmentSize;
+		BlockForNextAlloc = idx;
 
 #ifdef  TrackAllocations
 		AllocationPtr.append(ptr);
@@ -175,19 +190,15 @@ namespace Graph
 		AllocationPtr.size(AllocationPtr.size() - 1);
 #endif
 
+		// read owning block and allocated size from allocation header
 		auto pool = Pool.ptr<_HeapBlock>();
-		auto idx = (BlockForNextAlloc < Pool.size()) ? BlockForNextAlloc : Pool.size() - 1;
-		if ((_ptr < pool[idx].Ptr) || (((byte*)pool[idx].Ptr + pool[idx].Capacity) <= _ptr))
-		{
-			idx = Pool.size();
-			while ((idx-- > 0) && ((_ptr < pool[idx].Ptr) || (((byte*)pool[idx].Ptr + pool[idx].Capacity) <= _ptr)));
-			if (idx == 0)
-				return; // block is outside of this pool.
-		}
+		auto header = ((AllocationHeader*)_ptr) - 1;
+		auto idx = (SizeT)header->Block;
+		if ((idx >= Pool.size()) || (_ptr < pool[idx].Ptr) || (((byte*)pool[idx].Ptr + pool[idx].Capacity) <= _ptr))
+			return; // block is outside of this pool.
 
-		// read allocated size from allocation header
 		_HeapBlock& heap = pool[idx];
-		SizeT size = (SizeT)((size_t*)_ptr)[-1];
+		SizeT size = (SizeT)header->Size;
 		assert(IsAligned(size, AlignmentSize) && ((((byte*)_ptr) - (byte*)heap.Ptr + size) <= heap.Capacity));
 
 		BlockForNextAlloc = idx;
@@ -200,7 +211,7 @@ namespace Graph
 			{
 				if (((idx + 1) < Pool.capacity()) && (pool[idx + 1].Ptr != nullptr))
 				{
-					FreeMemory(((byte*)pool[idx + 1].Ptr) - pool[idx + 1].AlignmentGap);
+					FreeBlock(&pool[idx + 1]);
 					pool[idx + 1] = _HeapBlock(nullptr, 0);
 				}
 
@@ -292,6 +303,12 @@ namespace Graph
 	{
 		auto pool = Pool.ptr<_HeapBlock>();
 		auto idx = Pool.size();
+		auto capacity = (decltype(_HeapBlock::Capacity))GetAlignedSize(_blockSize, AlignmentSize) + AlignmentSize/*for aligning when needed*/;
+
+		//	A released block kept at the top of the pool is reused without a new allocation.
+		bool isAllocationNeeded = (idx == Pool.capacity()) || (pool[idx].Ptr == nullptr);
+		if (isAllocationNeeded && (Budget != nullptr) && !Budget->Reserve(capacity))
+			return nullptr;
 
 		if (idx == Pool.capacity())
 		{
@@ -310,7 +327,7 @@ namespace Graph
 		pool = Pool.ptr<_HeapBlock>();
 		if (pool[idx].Ptr == nullptr)
 		{
-			pool[idx].Capacity = (decltype(_HeapBlock::Capacity))GetAlignedSize(_blockSize, AlignmentSize) + AlignmentSize/*for aligning when needed*/;
+			pool[idx].Capacity = capacity;
 			pool[idx].Ptr = (byte*)AllocMemory(pool[idx].Capacity);
 
 			pool[idx].AlignmentGap = (int)(AlignmentSize - (((PtrInt)pool[idx].Ptr) & (AlignmentSize - 1)));
@@ -331,4 +348,109 @@ namespace Graph
 
 		return pool;
 	}
+
+	void StackMemoryPool::Trim()
+	{
+		auto pool = Pool.ptr<_HeapBlock>();
+
+		if ((Pool.size() < Pool.capacity()) && (pool[Pool.size()].Ptr != nullptr))
+		{
+			FreeBlock(&pool[Pool.size()]);
+			pool[Pool.size()] = _HeapBlock(nullptr, 0);
+		}
+	}
+
+	void StackMemoryPool::FreeBlock(void* _block)
+	{
+		auto& block = *(_HeapBlock*)_block;
+
+		FreeMemory(((byte*)block.Ptr) - block.AlignmentGap);
+		if (Budget != nullptr)
+			Budget->Release(block.Capacity + block.AlignmentGap);
+	}
+
+	StackArena::StackArena(size_t _chunkSize, MemoryBudget* _budget)
+		: Chunks(nullptr), ChunkCount(0), ChunkCapacity(0), Current(0), Offset(0),
+		  ChunkSize(GetAlignedSize(_chunkSize, AlignmentSize)), Budget(_budget)
+	{
+		if (_chunkSize == 0)
+			throw std::invalid_argument("_chunkSize");
+	}
+
+	StackArena::~StackArena()
+	{
+		FreeChunks(0);
+		delete[] Chunks;
+	}
+
+	void* StackArena::Allocate(size_t _size)
+	{
+		_size = GetAlignedSize(_size, AlignmentSize);
+		if (_size == 0)
+			return nullptr;
+
+		if ((Current >= ChunkCount) || ((Offset + _size) > Chunks[Current].Size))
+		{
+			//	Current == ChunkCount only while no chunk exists.
+			UInt32 next = (Current < ChunkCount) ? (Current + 1) : Current;
+
+			// Chunks after the current one are unused; one too small is replaced.
+			if ((next < ChunkCount) && (Chunks[next].Size < _size))
+				FreeChunks(next);
+
+			if ((next == ChunkCount) && !AddChunk((_size > ChunkSize) ? _size : ChunkSize))
+				return nullptr;
+
+			Current = next;
+			Offset = 0;
+		}
+
+		void* ptr = Chunks[Current].Ptr + Offset;
+		Offset += _size;
+
+		return ptr;
+	}
+
+	void StackArena::Trim()
+	{
+		if (ChunkCount > 0)
+			FreeChunks(Current + 1);
+	}
+
+	bool StackArena::AddChunk(size_t _size)
+	{
+		if ((Budget != nullptr) && !Budget->Reserve(_size))
+			return false;
+
+		if (ChunkCount == ChunkCapacity)
+		{
+			auto chunks = new Chunk[ChunkCapacity + 8];
+			for (UInt32 i = 0; i < ChunkCount; i++)
+				chunks[i] = Chunks[i];
+
+			delete[] Chunks;
+			Chunks = chunks;
+			ChunkCapacity += 8;
+		}
+
+		// AllocMemory() memory is 16 byte aligned.
+		Chunks[ChunkCount].Ptr = (byte*)AllocMemory(_size);
+		Chunks[ChunkCount].Size = _size;
+		ChunkCount++;
+
+		return true;
+	}
+
+	void StackArena::FreeChunks(UInt32 _first)
+	{
+		for (UInt32 i = _first; i < ChunkCount; i++)
+		{
+			FreeMemory(Chunks[i].Ptr);
+			if (Budget != nullptr)
+				Budget->Release(Chunks[i].Size);
+		}
+
+		if (_first < ChunkCount)
+			ChunkCount = _first;
+	}
 }
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#pragma once
+
+#if (!Parallel_H)
+#define Parallel_H
+
+#include "Types.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Graph
+{
+	namespace Parallel
+	{
+		// _threads == 0 : number of hardware threads.
+		inline UInt32 GetThreadCount(UInt32 _threads)
+		{
+			if (_threads == 0)
+				_threads = (UInt32)std::thread::hardware_concurrency();
+
+			return (_threads == 0) ? 1 : _threads;
+		}
+
+		/*
+		*	Invokes _body(threadIndex, itemIndex) for every itemIndex in [0, _count).
+		*	Items are handed out one at a time in ascending order, so expensive items should come first.
+		*	The first exception thrown by _body (const char*) is rethrown after all threads complete.
+		*/
+		template <class Body>
+		void For(size_t _count, UInt32 _threads, Body _body)
+		{
+			std::atomic<size_t>	next(0);
+			std::mutex				lock;
+			const char				*error = nullptr;
+			std::atomic<bool>		isFailed(false);
+
+			auto worker = [&](UInt32 _threadIndex)
+			{
+				try
+				{
+					for (size_t i = next++; (i < _count) && !isFailed; i = next++)
+						_body(_threadIndex, i);
+				}
+				catch (const char* e)
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					error = isFailed ? error : e;
+					isFailed = true;
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					error = isFailed ? error : "parallel task failed.";
+					isFailed = true;
+				}
+			};
+
+			_threads = GetThreadCount(_threads);
+			if (_threads > _count)
+				_threads = (_count == 0) ? 1 : (UInt32)_count;
+
+			std::vector<std::thread> threads;
+			for (UInt32 i = 1; i < _threads; i++)
+				threads.emplace_back(worker, i);
+
+			worker(0);
+
+			for (auto& thread : threads)
+				thread.join();
+
+			if (isFailed)
+				throw error;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#pragma once
+
+#if (!Platform_H)
+#define Platform_H
+
+/*
+*	Compiler and C runtime differences. MSVC uses its intrinsics and the secure CRT functions as they are; GCC and
+*	Clang get the same names over their builtins, which compile to the same instructions (POPCNT, TZCNT, PEXT) when
+*	built with -mpopcnt -mbmi -mbmi2 (see CMakeLists.txt).
+*/
+
+#if (defined(_MSC_VER))
+
+#include <intrin.h>
+
+#define forceinline	__forceinline
+
+#else
+
+#if (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#define forceinline	inline __attribute__((always_inline))
+
+#define __FUNCDNAME__	__PRETTY_FUNCTION__
+
+forceinline unsigned int __popcnt(unsigned int _value)
+{
+	return (unsigned int)__builtin_popcount(_value);
+}
+
+forceinline unsigned long long __popcnt64(unsigned long long _value)
+{
+	return (unsigned long long)__builtin_popcountll(_value);
+}
+
+forceinline unsigned char _BitScanForward64(unsigned long* _index, unsigned long long _mask)
+{
+	if (_mask == 0)
+		return 0;
+
+	*_index = (unsigned long)__builtin_ctzll(_mask);
+	return 1;
+}
+
+forceinline unsigned char _bittestandreset64(long long* _base, long long _offset)
+{
+	unsigned char bit = (unsigned char)(((unsigned long long)*_base >> _offset) & 1);
+	*_base &= ~(long long)(1ULL << _offset);
+	return bit;
+}
+
+#define sprintf_s		snprintf
+#define strtok_s		strtok_r
+
+inline int fopen_s(FILE** _file, const char* _fileName, const char* _mode)
+{
+	*_file = fopen(_fileName, _mode);
+	return (*_file == nullptr) ? 1 : 0;
+}
+
+inline int strcpy_s(char* _dest, size_t _size, const char* _src)
+{
+	size_t length = strlen(_src);
+	if (length >= _size)
+	{
+		if (_size > 0)
+			_dest[0] = 0;
+
+		return 1;
+	}
+
+	memcpy(_dest, _src, length + 1);
+	return 0;
+}
+
+#endif
+
+#endif
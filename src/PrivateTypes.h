@@ -17,6 +17,7 @@
 #define PrivateTypes_H
 
 #include <limits>
+#include <limits.h>
 
 #include "Types.h"
 
@@ -33,31 +34,126 @@ namespace Graph
 		virtual ~IMemoryPool() {};
 	};
 
+	//	Hard limit on the memory held by a set of pools; Limit == 0 : unlimited.
+	class MemoryBudget
+	{
+	public:
+		MemoryBudget(size_t _limit = 0) : Limit(_limit), Used(0), HighWater(0) {};
+
+		// false : _size does not fit in the remaining budget; nothing is reserved.
+		bool Reserve(size_t _size)
+		{
+			if ((Limit != 0) && ((Used + _size) > Limit))
+				return false;
+
+			Used += _size;
+			if (HighWater < Used)
+				HighWater = Used;
+
+			return true;
+		}
+
+		void Release(size_t _size) { Used -= _size; };
+
+		// Less than 1/8 of the budget is left; graph memory should give way to scratch memory.
+		bool IsNearLimit() const { return (Limit != 0) && (Used >= (Limit - (Limit >> 3))); };
+
+	public:
+		size_t	Limit, Used, HighWater;
+	};
+
 	class StackMemoryPool : public IMemoryPool
 	{
 	public:
 		typedef UInt32 SizeT;
 
-		StackMemoryPool(SizeT _blockSize/*Largest allowed allocation size*/, SizeT _maxPoolSize = UINT_MAX);
+		StackMemoryPool(SizeT _blockSize/*Largest allowed allocation size*/, SizeT _maxPoolSize = UINT_MAX, MemoryBudget* _budget = nullptr);
 		~StackMemoryPool();
 
 		// _size should be allways <= BlockSize.
 		void* Allocate(size_t _size);
 		void Free(void* _ptr);
 
+		// Releases the emptied block kept for reuse.
+		void Trim();
+
 	private:
+		// nullptr : the budget does not allow another block.
 		void*	AddBlock(SizeT _blockSize);
+		void	FreeBlock(void* _block);
 
 	private:
 		Ext::VList<SizeT> Pool;
 		SizeT BlockSize, MaxPoolSize;
 		SizeT BlockForNextAlloc;
+		MemoryBudget* Budget;
 
 #ifdef TrackAllocations
 		Ext::List<void*, SizeT> AllocationPtr;
 #endif
 	};
 
+	//	Position in a StackArena; everything allocated after it is discarded by StackArena::Release().
+	struct ArenaMark
+	{
+		ArenaMark() : Chunk(0), Offset(0) {};
+
+		UInt32	Chunk;
+		size_t	Offset;
+	};
+
+	/*
+	*	Bump pointer allocator for strictly LIFO lifetimes (e.g. per call frame scratch). An allocation is a pointer
+	*	increment and Release(mark) a pointer reset; chunks are kept for reuse until Trim().
+	*/
+	class StackArena
+	{
+	public:
+		StackArena(size_t _chunkSize, MemoryBudget* _budget = nullptr);
+		~StackArena();
+
+		// nullptr : the budget does not allow another chunk.
+		void* Allocate(size_t _size);
+
+		ArenaMark Mark() const
+		{
+			ArenaMark mark;
+			mark.Chunk = Current;
+			mark.Offset = Offset;
+			return mark;
+		}
+
+		void Release(const ArenaMark& _mark)
+		{
+			Current = _mark.Chunk;
+			Offset = _mark.Offset;
+		}
+
+		// Frees the chunks after the current one.
+		void Trim();
+
+	private:
+		StackArena(const StackArena&) = delete;
+		StackArena& operator=(const StackArena&) = delete;
+
+		bool AddChunk(size_t _size);
+		void FreeChunks(UInt32 _first);
+
+	private:
+		struct Chunk
+		{
+			byte*		Ptr;
+			size_t	Size;
+		};
+
+		Chunk		*Chunks;
+		UInt32	ChunkCount, ChunkCapacity;
+		UInt32	Current;
+		size_t	Offset;
+		size_t	ChunkSize;
+		MemoryBudget* Budget;
+	};
+
 	class ReleaseMemoryToPool
 	{
 	public:
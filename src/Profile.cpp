@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "Profile.h"
+#include "MemoryAllocation.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Graph
+{
+	namespace Clique
+	{
+		static const char* s_StageNames[] =
+		{
+			"Order", "ExtractPartition", "Bound", "Neighbourhood", "BottomUpCheck", "SubgraphExtraction", "RemoveVertexAndEquivalent"
+		};
+
+		static_assert(sizeof(s_StageNames) / sizeof(s_StageNames[0]) == (size_t)Stage::Count, "s_StageNames is out of sync with Stage.");
+
+		// Cycles, Calls, Nodes, SampledNodes, Children and Sampled in one allocation.
+		static size_t GetProfileAllocationSize(UInt32 _depths)
+		{
+			return sizeof(UInt64) * (2 * (UInt32)Stage::Count + 3) * _depths + _depths;
+		}
+
+		SearchProfile::SearchProfile(UInt32 _depths, UInt32 _samplingInterval)
+			: Depths((_depths == 0) ? 1 : _depths), SamplingInterval((_samplingInterval == 0) ? 1 : _samplingInterval), TimerCycles(0)
+		{
+			Cycles = (UInt64*)AllocMemory(GetProfileAllocationSize(Depths));
+			Calls = Cycles + (UInt32)Stage::Count * Depths;
+			Nodes = Calls + (UInt32)Stage::Count * Depths;
+			SampledNodes = Nodes + Depths;
+			Children = SampledNodes + Depths;
+			Sampled = (byte*)(Children + Depths);
+
+			// Cost of a timed stage as TryFindClique pays it; reported as the overhead of the profile.
+			const UInt32 samples = 1024;
+			UInt64 start = ReadTimeStampCounter(), begin;
+			for (UInt32 i = 0; i < samples; i++)
+			{
+				begin = ReadTimeStampCounter();
+				AddStage(Stage::Order, 0, ReadTimeStampCounter() - begin);
+			}
+
+			TimerCycles = (double)(ReadTimeStampCounter() - start) / samples;
+			Clear();
+		}
+
+		SearchProfile::~SearchProfile()
+		{
+			FreeMemory(Cycles);
+			Cycles = Calls = Nodes = SampledNodes = Children = nullptr;
+			Sampled = nullptr;
+		}
+
+		void SearchProfile::Clear()
+		{
+			memset(Cycles, 0, GetProfileAllocationSize(Depths));
+			memset(SubgraphSizes, 0, sizeof(SubgraphSizes));
+			memset(BranchingFactors, 0, sizeof(BranchingFactors));
+
+			IsStopped = false;
+			StartTime = StopTime = std::chrono::steady_clock::now();
+			StartCycles = StopCycles = ReadTimeStampCounter();
+		}
+
+		void SearchProfile::Stop()
+		{
+			StopTime = std::chrono::steady_clock::now();
+			StopCycles = ReadTimeStampCounter();
+			IsStopped = true;
+		}
+
+		static void AppendHistogram(std::string& _text, const char* _title, const UInt64* _buckets, UInt32 _count)
+		{
+			char sz[128];
+			UInt32 i, last = 0;
+
+			for (i = 0; i < _count; i++)
+				if (_buckets[i] != 0)
+					last = i + 1;
+
+			_text += _title;
+			for (i = 0; i < last; i++)
+			{
+				UInt64 low = (i == 0) ? 0 : (1ULL << (i - 1)), high = (i == 0) ? 1 : (1ULL << i);
+				sprintf_s(sz, sizeof(sz), "  [%10llu, %10llu) %15llu\n", low, high, _buckets[i]);
+				_text += sz;
+			}
+		}
+
+		void SearchProfile::Report(std::string& _text) const
+		{
+			char sz[256];
+			UInt32 depth, stage, depths = 0;
+			UInt64 totalCalls = 0, stageCalls[(UInt32)Stage::Count];
+			double totalCycles = 0, stageCycles[(UInt32)Stage::Count];
+
+			auto stopTime = IsStopped ? StopTime : std::chrono::steady_clock::now();
+			auto stopCycles = IsStopped ? StopCycles : ReadTimeStampCounter();
+			double elapsedMs = std::chrono::duration<double, std::milli>(stopTime - StartTime).count();
+			double cyclesPerMs = (elapsedMs > 0) ? ((stopCycles - StartCycles) / elapsedMs) : 1;
+			if (cyclesPerMs <= 0)
+				cyclesPerMs = 1;
+
+			// Sampled cycles scaled to all nodes of the depth.
+			auto getCycles = [&](UInt32 _depth, UInt32 _stage) -> double
+			{
+				return (SampledNodes[_depth] == 0) ? 0.0 : ((double)Cycles[_depth * (UInt32)Stage::Count + _stage] * Nodes[_depth] / SampledNodes[_depth]);
+			};
+
+			memset(stageCycles, 0, sizeof(stageCycles));
+			memset(stageCalls, 0, sizeof(stageCalls));
+			for (depth = 0; depth < Depths; depth++)
+			{
+				if (Nodes[depth] != 0)
+					depths = depth + 1;
+
+				for (stage = 0; stage < (UInt32)Stage::Count; stage++)
+				{
+					stageCycles[stage] += getCycles(depth, stage);
+					stageCalls[stage] += Calls[depth * (UInt32)Stage::Count + stage];
+				}
+			}
+
+			for (stage = 0; stage < (UInt32)Stage::Count; stage++)
+			{
+				totalCycles += stageCycles[stage];
+				totalCalls += stageCalls[stage];
+			}
+
+			double overheadMs = totalCalls * TimerCycles / cyclesPerMs;
+			sprintf_s(sz, sizeof(sz), "Profile: %.3f ms, %.3f counter ticks/ns, 1/%u nodes sampled, %llu timed stages, overhead ~%.3f ms (%.2f%%)\n",
+				elapsedMs, cyclesPerMs / 1e6, SamplingInterval, totalCalls, overheadMs, (elapsedMs > 0) ? (100 * overheadMs / elapsedMs) : 0.0);
+			_text += sz;
+
+			sprintf_s(sz, sizeof(sz), "%26s %15s %15s %8s\n", "Stage", "Timed", "ms", "%");
+			_text += sz;
+			for (stage = 0; stage < (UInt32)Stage::Count; stage++)
+			{
+				sprintf_s(sz, sizeof(sz), "%26s %15llu %15.3f %8.2f\n", s_StageNames[stage], stageCalls[stage], stageCycles[stage] / cyclesPerMs,
+					(elapsedMs > 0) ? (100 * stageCycles[stage] / cyclesPerMs / elapsedMs) : 0.0);
+				_text += sz;
+			}
+
+			sprintf_s(sz, sizeof(sz), "%26s %15llu %15.3f %8.2f\n", "Timed", totalCalls, totalCycles / cyclesPerMs, (elapsedMs > 0) ? (100 * totalCycles / cyclesPerMs / elapsedMs) : 0.0);
+			_text += sz;
+
+			// ms by depth and stage.
+			sprintf_s(sz, sizeof(sz), "%6s %15s", "Depth", "Nodes");
+			_text += sz;
+			for (stage = 0; stage < (UInt32)Stage::Count; stage++)
+			{
+				sprintf_s(sz, sizeof(sz), " %12.12s", s_StageNames[stage]);
+				_text += sz;
+			}
+
+			_text += "\n";
+			for (depth = 0; depth < depths; depth++)
+			{
+				sprintf_s(sz, sizeof(sz), "%6u %15llu", depth + 1, Nodes[depth]);
+				_text += sz;
+				for (stage = 0; stage < (UInt32)Stage::Count; stage++)
+				{
+					sprintf_s(sz, sizeof(sz), " %12.3f", getCycles(depth, stage) / cyclesPerMs);
+					_text += sz;
+				}
+
+				_text += "\n";
+			}
+
+			AppendHistogram(_text, "Subgraph size (log2 buckets):\n", SubgraphSizes, Buckets);
+			AppendHistogram(_text, "Branching factor, subgraphs pushed per node (log2 buckets):\n", BranchingFactors, Buckets);
+		}
+	}
+}
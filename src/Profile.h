@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#pragma once
+
+#if (!Profile_H)
+#define Profile_H
+
+#include "Counters.h"
+
+#include <string>
+#include <chrono>
+
+/*
+*	CliqueProfile : 1 compiles the stage timers into TryFindClique (default : CliqueCounters); they still run only
+*	for ResourceManagers created after SetProfiling(true). 0 removes them.
+*/
+#if (!defined(CliqueProfile))
+#define CliqueProfile CliqueCounters
+#endif
+
+namespace Graph
+{
+	// Time stamp counter; a steady clock in nanoseconds where there is none.
+	inline UInt64 ReadTimeStampCounter()
+	{
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+		return __rdtsc();
+#else
+		return (UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	namespace Clique
+	{
+		// Stages of a TryFindClique frame, in the order they run.
+		enum struct Stage : UInt32
+		{
+			Order = 0,						// degree sort of the vertices on enter.
+			ExtractPartition,
+			Bound,							// edge count and coloring bounds; the coloring search itself is in its own frames.
+			Neighbourhood,					// pivot neighbourhood reduction and its equivalent vertices.
+			BottomUpCheck,
+			SubgraphExtraction,
+			RemoveVertexAndEquivalent,
+
+			Count
+		};
+
+		/*
+		*	Cycles and calls of each Stage by depth, nodes (frames entered) by depth, and log2 bucket histograms of the
+		*	subgraph sizes searched and of the branching factor (subgraphs pushed by a frame).
+		*	Bucket 0 : 0, bucket b : [2^(b-1), 2^b).
+		*	Stages are timed in one of every _samplingInterval nodes of a depth (the first one always) and scaled by
+		*	nodes / sampled nodes of the depth in the report; nodes and histograms are exact.
+		*/
+		class SearchProfile
+		{
+		public:
+			static const UInt32 Buckets = 33;
+
+			SearchProfile(UInt32 _depths, UInt32 _samplingInterval);
+			~SearchProfile();
+
+			void Clear();
+			void Stop();
+
+			forceinline void AddStage(Stage _stage, UInt32 _depth, UInt64 _cycles)
+			{
+				auto idx = Row(_depth) + (UInt32)_stage;
+				Cycles[idx] += _cycles;
+				Calls[idx]++;
+			}
+
+			forceinline bool IsSampled(UInt32 _depth) const
+			{
+				return Sampled[(_depth < Depths) ? _depth : (Depths - 1)] != 0;
+			}
+
+			forceinline void Enter(UInt32 _depth)
+			{
+				_depth = (_depth < Depths) ? _depth : (Depths - 1);
+				Sampled[_depth] = ((Nodes[_depth] % SamplingInterval) == 0) ? 1 : 0;
+				SampledNodes[_depth] += Sampled[_depth];
+				Nodes[_depth]++;
+				Children[_depth] = 0;
+			}
+
+			forceinline void Push(UInt32 _depth, UInt32 _subGraphSize)
+			{
+				SubgraphSizes[GetBucket(_subGraphSize)]++;
+				Children[(_depth < Depths) ? _depth : (Depths - 1)]++;
+			}
+
+			forceinline void Leave(UInt32 _depth)
+			{
+				BranchingFactors[GetBucket(Children[(_depth < Depths) ? _depth : (Depths - 1)])]++;
+			}
+
+			static UInt32 GetBucket(UInt32 _value)
+			{
+				UInt32 bucket = 0;
+				for (; _value != 0; _value >>= 1)
+					bucket++;
+
+				return bucket;
+			}
+
+			// Summary : stage totals, per depth time, histograms and the measured cost of the timers themselves.
+			void Report(std::string& _text) const;
+
+		private:
+			SearchProfile(const SearchProfile&) = delete;
+			SearchProfile& operator=(const SearchProfile&) = delete;
+
+			UInt32 Row(UInt32 _depth) const { return ((_depth < Depths) ? _depth : (Depths - 1)) * (UInt32)Stage::Count; }
+
+		private:
+			UInt32	Depths, SamplingInterval;
+			UInt64	*Cycles, *Calls;				// [Depths][Stage::Count]
+			UInt64	*Nodes, *SampledNodes, *Children;	// [Depths]
+			byte		*Sampled;						// [Depths] : stages of the current node of the depth are timed.
+			UInt64	SubgraphSizes[Buckets], BranchingFactors[Buckets];
+
+			UInt64	StartCycles, StopCycles;
+			std::chrono::steady_clock::time_point	StartTime, StopTime;
+			bool		IsStopped;
+			double	TimerCycles;						// cost of one timed stage (two counter reads and AddStage), measured at construction.
+		};
+	}
+}
+
+#if (CliqueProfile)
+#define ProfileBegin(profile, depth, start)			((((profile) != nullptr) && (profile)->IsSampled((UInt32)(depth))) ? (void)((start) = Graph::ReadTimeStampCounter()) : (void)0)
+#define ProfileEnd(profile, stage, depth, start)		((((profile) != nullptr) && (profile)->IsSampled((UInt32)(depth))) ? (profile)->AddStage(Graph::Clique::Stage::stage, (UInt32)(depth), Graph::ReadTimeStampCounter() - (start)) : (void)0)
+#define ProfileEnter(profile, depth)					(((profile) != nullptr) ? (profile)->Enter((UInt32)(depth)) : (void)0)
+#define ProfilePush(profile, depth, size)				(((profile) != nullptr) ? (profile)->Push((UInt32)(depth), (UInt32)(size)) : (void)0)
+#define ProfileLeave(profile, depth)					(((profile) != nullptr) ? (profile)->Leave((UInt32)(depth)) : (void)0)
+#else
+#define ProfileBegin(profile, depth, start)			((void)0)
+#define ProfileEnd(profile, stage, depth, start)		((void)0)
+#define ProfileEnter(profile, depth)					((void)0)
+#define ProfilePush(profile, depth, size)				((void)0)
+#define ProfileLeave(profile, depth)					((void)0)
+#endif
+
+#endif
@@ -0,0 +1,668 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#include "Server.h"
+#include "MemoryAllocation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+
+typedef SOCKET SocketHandle;
+#define InvalidSocket		INVALID_SOCKET
+#define CloseSocket(s)		closesocket(s)
+#define UnlinkSocketPath(p)	_unlink(p)
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <signal.h>
+
+typedef int SocketHandle;
+#define InvalidSocket		(-1)
+#define CloseSocket(s)		close(s)
+#define UnlinkSocketPath(p)	unlink(p)
+#endif
+
+namespace Graph
+{
+	namespace Server
+	{
+		struct GraphEntry
+		{
+		public:
+			GraphEntry(Ext::Array<Vertex> _graph, bool _isMapped)
+				: Graph(_graph), IsMapped(_isMapped)
+			{
+			}
+
+			GraphEntry(TriangularGraph _graph)
+				: Graph(), Triangular(_graph), IsMapped(false)
+			{
+			}
+
+			~GraphEntry()
+			{
+				if (IsTriangular())
+					FreeTriangularGraph(Triangular);
+				else if (IsMapped)
+					UnmapGraphCache(Graph);
+				else
+					FreeGraph(Graph);
+			}
+
+			bool IsTriangular() const { return Triangular.size() > 0; }
+
+			size_t size() const { return IsTriangular() ? Triangular.size() : Graph.size(); }
+
+		public:
+			Ext::Array<Vertex>	Graph;			// empty when kept as Triangular.
+			TriangularGraph		Triangular;
+			bool						IsMapped;
+		};
+
+		// Resident graphs by name; queries hold a reference so that UNLOAD does not free a graph in use.
+		class GraphStore
+		{
+		public:
+			void Set(const std::string& _name, const std::shared_ptr<GraphEntry>& _entry)
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				Graphs[_name] = _entry;
+			}
+
+			std::shared_ptr<GraphEntry> Get(const std::string& _name)
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				auto it = Graphs.find(_name);
+				return (it == Graphs.end()) ? std::shared_ptr<GraphEntry>() : it->second;
+			}
+
+			bool Remove(const std::string& _name)
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				return Graphs.erase(_name) > 0;
+			}
+
+			void List(std::string& _response)
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				char sz[32];
+
+				sprintf_s(sz, sizeof(sz), " %d", (int)Graphs.size());
+				_response += sz;
+				for (auto& it : Graphs)
+				{
+					sprintf_s(sz, sizeof(sz), ":%d", (int)it.second->size());
+					_response += " " + it.first + sz;
+				}
+			}
+
+		private:
+			std::mutex Lock;
+			std::map<std::string, std::shared_ptr<GraphEntry>> Graphs;
+		};
+
+		GraphStore* CreateGraphStore()
+		{
+			return new GraphStore();
+		}
+
+		void FreeGraphStore(GraphStore* _store)
+		{
+			delete _store;
+		}
+
+		const char* LoadGraph(GraphStore& _store, const char* _name, const char* _path, bool _triangular, ID* _pVertices)
+		{
+			bool isMapped = true;
+			auto graph = MapGraphCache(_path);
+
+			if (graph.ptr() == nullptr)
+			{
+				isMapped = false;
+				graph = ReadDIMACSGraph(_path);
+			}
+
+			if (graph.size() == 0)
+			{
+				if (isMapped)
+					UnmapGraphCache(graph);
+				else if (graph.ptr() != nullptr)
+					FreeGraph(graph);
+
+				return "unable to read graph.";
+			}
+
+			if (_pVertices != nullptr)
+				*_pVertices = (ID)graph.size();
+
+			if (_triangular)
+			{
+				auto triangular = CreateTriangularGraph(graph);
+
+				if (isMapped)
+					UnmapGraphCache(graph);
+				else
+					FreeGraph(graph);
+
+				_store.Set(_name, std::make_shared<GraphEntry>(triangular));
+			}
+			else
+				_store.Set(_name, std::make_shared<GraphEntry>(graph, isMapped));
+
+			return nullptr;
+		}
+
+		static void AppendIds(std::string& _response, const ID* _ids, ID _count)
+		{
+			char sz[16];
+
+			for (ID i = 0; i < _count; i++)
+			{
+				sprintf_s(sz, sizeof(sz), " %d", (int)_ids[i]);
+				_response += sz;
+			}
+		}
+
+		static bool ParseId(const char* _token, ID& _value)
+		{
+			char* end = nullptr;
+			long value = (_token == nullptr) ? -1 : strtol(_token, &end, 10);
+
+			if ((_token == nullptr) || (*end != 0) || (value < 0))
+				return false;
+
+			_value = (ID)value;
+			return true;
+		}
+
+		bool ProcessRequest(GraphStore& _store, Clique::Solver& _solver, const char* _request, std::string& _response, bool& _shutdown)
+		{
+			std::vector<char> line(_request, _request + strlen(_request) + 1);
+			std::vector<const char*> tokens;
+			char *context = nullptr;
+
+			for (char* token = strtok_s(line.data(), " \t\r\n", &context); token != nullptr; token = strtok_s(nullptr, " \t\r\n", &context))
+				tokens.push_back(token);
+
+			_response = "OK";
+			if (tokens.size() == 0)
+			{
+				_response = "ERR empty request";
+				return true;
+			}
+
+			std::string command(tokens[0]);
+			char sz[32];
+
+			try
+			{
+				if (command == "PING")
+				{
+					_response += " PONG";
+				}
+				else if (command == "QUIT")
+				{
+					return false;
+				}
+				else if (command == "SHUTDOWN")
+				{
+					_shutdown = true;
+					return false;
+				}
+				else if (command == "LIST")
+				{
+					_store.List(_response);
+				}
+				else if ((command == "LOAD") && ((tokens.size() == 3) || ((tokens.size() == 4) && (strcmp(tokens[3], "TRIANGULAR") == 0))))
+				{
+					ID vertices = 0;
+					auto error = LoadGraph(_store, tokens[1], tokens[2], tokens.size() == 4, &vertices);
+					if (error != nullptr)
+						_response = std::string("ERR ") + error;
+					else
+					{
+						sprintf_s(sz, sizeof(sz), " %d", (int)vertices);
+						_response += sz;
+					}
+				}
+				else if ((command == "UNLOAD") && (tokens.size() == 2))
+				{
+					if (!_store.Remove(tokens[1]))
+						_response = "ERR unknown graph";
+				}
+				else if ((command == "SAVE") && (tokens.size() == 3))
+				{
+					auto entry = _store.Get(tokens[1]);
+					if (entry == nullptr)
+						_response = "ERR unknown graph";
+					else if (entry->IsTriangular())
+					{
+						// The cache keeps dense rows, so that a mapped view is searched in place.
+						auto graph = CloneGraph(entry->Triangular);
+						bool isSaved = SaveGraphCache(tokens[2], graph);
+
+						FreeGraph(graph);
+						if (!isSaved)
+							_response = "ERR unable to write graph cache";
+					}
+					else if (!SaveGraphCache(tokens[2], entry->Graph))
+						_response = "ERR unable to write graph cache";
+				}
+				else if (((command == "MAXCLIQUE") && (tokens.size() == 2)) ||
+					((command == "HASCLIQUE") && (tokens.size() == 3)) ||
+					((command == "VERTEXCLIQUE") && (tokens.size() == 3)) ||
+					((command == "COLOR") && (tokens.size() >= 2) && (tokens.size() <= 4)) ||
+					((command == "CHROMATIC") && (tokens.size() >= 2) && (tokens.size() <= 3)))
+				{
+					auto entry = _store.Get(tokens[1]);
+					if (entry == nullptr)
+					{
+						_response = "ERR unknown graph";
+						return true;
+					}
+
+					ID argument = 0;
+					if ((tokens.size() == 3) && (command != "COLOR") && !ParseId(tokens[2], argument))
+					{
+						_response = "ERR invalid argument";
+						return true;
+					}
+
+					auto graph = entry->Graph;
+					auto& triangular = entry->Triangular;
+					auto size = (ID)entry->size();
+
+					if (command == "MAXCLIQUE")
+					{
+						auto cliqueSize = entry->IsTriangular() ? _solver.FindClique(triangular) : _solver.FindClique(graph);
+						sprintf_s(sz, sizeof(sz), " %d", (int)cliqueSize);
+						_response += sz;
+						AppendIds(_response, _solver.CliqueMembers().ptr(), _solver.CliqueMembers().size());
+					}
+					else if (command == "HASCLIQUE")
+					{
+						// ExactSearch expects k >= 3; smaller sizes are answered by the maximum clique.
+						auto op = (argument < 3) ? Clique::FindOperation::MaximumClique : Clique::FindOperation::ExactSearch;
+						auto cliqueSizeArgument = (argument < 3) ? INVALID_ID : argument;
+						auto cliqueSize = (argument > size) ? 0 :
+							(entry->IsTriangular() ? _solver.FindClique(triangular, cliqueSizeArgument, op) : _solver.FindClique(graph, cliqueSizeArgument, op));
+
+						if ((cliqueSize != INVALID_ID) && (cliqueSize >= argument) && (cliqueSize > 0))
+						{
+							sprintf_s(sz, sizeof(sz), " 1 %d", (int)_solver.CliqueMembers().size());
+							_response += sz;
+							AppendIds(_response, _solver.CliqueMembers().ptr(), _solver.CliqueMembers().size());
+						}
+						else
+							_response += " 0";
+					}
+					else if (command == "VERTEXCLIQUE")
+					{
+						if (argument >= size)
+						{
+							_response = "ERR invalid vertex";
+							return true;
+						}
+
+						auto cliqueSize = entry->IsTriangular() ? _solver.FindVertexClique(triangular, argument) : _solver.FindVertexClique(graph, argument);
+						sprintf_s(sz, sizeof(sz), " %d", (int)cliqueSize);
+						_response += sz;
+						AppendIds(_response, _solver.CliqueMembers().ptr(), _solver.CliqueMembers().size());
+					}
+					else if (command == "CHROMATIC")
+					{
+						// argument : time limit in ms, 0 (none) when absent.
+						std::vector<ID> vertexColor(size);
+						ID lowerBound = 0;
+						auto colors = entry->IsTriangular() ?
+							_solver.GetChromaticNumber(triangular, nullptr, Ext::Array<ID>(vertexColor.data(), size), &lowerBound, argument) :
+							_solver.GetChromaticNumber(graph, nullptr, Ext::Array<ID>(vertexColor.data(), size), &lowerBound, argument);
+						sprintf_s(sz, sizeof(sz), " %d %d", (int)colors, (int)lowerBound);
+						_response += sz;
+						AppendIds(_response, vertexColor.data(), size);
+					}
+					else // if (command == "COLOR")
+					{
+						auto mode = ColoringMode::Exact;
+						if (tokens.size() >= 3)
+						{
+							if (strcmp(tokens[2], "DSATUR") == 0)
+								mode = ColoringMode::DSatur;
+							else if (strcmp(tokens[2], "RLF") == 0)
+								mode = ColoringMode::RecursiveLargestFirst;
+							else if (strcmp(tokens[2], "JP") == 0)
+								mode = ColoringMode::JonesPlassmann;
+							else if (strcmp(tokens[2], "EXACT") != 0)
+							{
+								_response = "ERR invalid argument";
+								return true;
+							}
+						}
+
+						ID tabuIterations = 0;
+						if ((tokens.size() == 4) && ((mode == ColoringMode::Exact) || !ParseId(tokens[3], tabuIterations)))
+						{
+							_response = "ERR invalid argument";
+							return true;
+						}
+
+						std::vector<ID> vertexColor(size);
+						auto colors = entry->IsTriangular() ?
+							_solver.GetColoring(triangular, mode, nullptr, Ext::Array<ID>(vertexColor.data(), size), tabuIterations) :
+							_solver.GetColoring(graph, mode, nullptr, Ext::Array<ID>(vertexColor.data(), size), tabuIterations);
+						sprintf_s(sz, sizeof(sz), " %d", (int)colors);
+						_response += sz;
+						AppendIds(_response, vertexColor.data(), size);
+					}
+				}
+				else
+				{
+					_response = "ERR unknown command or invalid arguments";
+				}
+			}
+			catch (const char* error)
+			{
+				_response = std::string("ERR ") + error;
+			}
+			catch (...)
+			{
+				_response = "ERR internal error";
+			}
+
+			return true;
+		}
+
+		static bool SendAll(SocketHandle _socket, const std::string& _data)
+		{
+			size_t sent = 0;
+
+			while (sent < _data.size())
+			{
+				auto count = send(_socket, _data.c_str() + sent, (int)(_data.size() - sent), 0);
+				if (count <= 0)
+					return false;
+
+				sent += (size_t)count;
+			}
+
+			return true;
+		}
+
+		// Accepted connections are queued to the workers; each worker serves one connection at a time.
+		class ConnectionQueue
+		{
+		public:
+			ConnectionQueue()
+				: IsStopped(false)
+			{
+			}
+
+			void Push(SocketHandle _socket)
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				Connections.push_back(_socket);
+				Signal.notify_one();
+			}
+
+			bool Pop(SocketHandle& _socket)
+			{
+				std::unique_lock<std::mutex> lock(Lock);
+				Signal.wait(lock, [this] { return IsStopped || !Connections.empty(); });
+
+				if (Connections.empty())
+					return false;
+
+				_socket = Connections.front();
+				Connections.pop_front();
+				return true;
+			}
+
+			void Stop()
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				IsStopped = true;
+				Signal.notify_all();
+			}
+
+		private:
+			std::mutex Lock;
+			std::condition_variable Signal;
+			std::deque<SocketHandle> Connections;
+			bool IsStopped;
+		};
+
+		struct ServerContext
+		{
+			ServerContext(GraphStore& _store)
+				: Store(_store), Listener(InvalidSocket), IsShutdown(false)
+			{
+			}
+
+			// Wakes up accept() and the workers blocked on idle connections.
+			void Shutdown()
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				IsShutdown = true;
+
+				for (auto socket : Active)
+					shutdown(socket, 2);
+
+#ifdef _WIN32
+				CloseSocket(Listener);
+#else
+				shutdown(Listener, SHUT_RDWR);
+#endif
+			}
+
+			bool Attach(SocketHandle _socket)
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				if (IsShutdown)
+					return false;
+
+				Active.push_back(_socket);
+				return true;
+			}
+
+			void Detach(SocketHandle _socket)
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				for (size_t i = 0; i < Active.size(); i++)
+				{
+					if (Active[i] == _socket)
+					{
+						Active[i] = Active.back();
+						Active.pop_back();
+						break;
+					}
+				}
+			}
+
+			GraphStore&					Store;
+			ConnectionQueue			Queue;
+			SocketHandle				Listener;
+			std::atomic<bool>			IsShutdown;
+			std::mutex					Lock;
+			std::vector<SocketHandle>	Active;
+		};
+
+		static void ServeConnection(ServerContext& _context, SocketHandle _socket, Clique::Solver& _solver)
+		{
+			std::string pending, response;
+			char buffer[4096];
+			bool isOpen = true;
+
+			while (isOpen)
+			{
+				auto count = recv(_socket, buffer, sizeof(buffer), 0);
+				if (count <= 0)
+					break;
+
+				pending.append(buffer, (size_t)count);
+
+				size_t eol;
+				while (isOpen && ((eol = pending.find('\n')) != std::string::npos))
+				{
+					std::string request = pending.substr(0, eol);
+					pending.erase(0, eol + 1);
+
+					bool isShutdown = false;
+					isOpen = ProcessRequest(_context.Store, _solver, request.c_str(), response, isShutdown);
+
+					if (isShutdown)
+					{
+						SendAll(_socket, "OK\n");
+						_context.Shutdown();
+					}
+					else if (isOpen && !SendAll(_socket, response + "\n"))
+						isOpen = false;
+				}
+
+				if (isOpen && (pending.size() > MaxRequestLength))
+				{
+					SendAll(_socket, "ERR request too long\n");
+					isOpen = false;
+				}
+			}
+		}
+
+		static void Worker(ServerContext* _context)
+		{
+			Clique::Solver solver;
+			SocketHandle socket;
+
+			while (_context->Queue.Pop(socket))
+			{
+				if (_context->Attach(socket))
+				{
+					ServeConnection(*_context, socket, solver);
+					_context->Detach(socket);
+				}
+
+				CloseSocket(socket);
+			}
+		}
+
+		int Run(const Options& _options, int _graphCount, char* _graphs[])
+		{
+			if ((_options.SocketPath == nullptr) || (strlen(_options.SocketPath) >= sizeof(((sockaddr_un*)nullptr)->sun_path)))
+			{
+				printf("Invalid socket path.\r\n");
+				return 1;
+			}
+
+#ifdef _WIN32
+			WSADATA wsaData;
+			if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+				return 1;
+#else
+			signal(SIGPIPE, SIG_IGN);
+#endif
+
+			std::unique_ptr<GraphStore, void(*)(GraphStore*)> store(CreateGraphStore(), FreeGraphStore);
+
+			for (int i = 0; i < _graphCount; i++)
+			{
+				std::string arg(_graphs[i]);
+				auto separator = arg.find('=');
+				auto error = (separator == std::string::npos) ? "expected name=path." : LoadGraph(*store, arg.substr(0, separator).c_str(), arg.c_str() + separator + 1, _options.Triangular);
+
+				if (error != nullptr)
+				{
+					printf("%s : %s\r\n", _graphs[i], error);
+					return 1;
+				}
+			}
+
+			ServerContext context(*store);
+			context.Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (context.Listener == InvalidSocket)
+			{
+				printf("Unable to create socket.\r\n");
+				return 1;
+			}
+
+			sockaddr_un address;
+			memset(&address, 0, sizeof(address));
+			address.sun_family = AF_UNIX;
+			strncpy(address.sun_path, _options.SocketPath, sizeof(address.sun_path) - 1);
+			UnlinkSocketPath(_options.SocketPath);
+
+			if ((bind(context.Listener, (sockaddr*)&address, sizeof(address)) != 0) || (listen(context.Listener, 64) != 0))
+			{
+				printf("Unable to listen on %s.\r\n", _options.SocketPath);
+				CloseSocket(context.Listener);
+				return 1;
+			}
+
+			UInt32 workers = (_options.Workers > 0) ? _options.Workers : (UInt32)std::thread::hardware_concurrency();
+			if (workers == 0)
+				workers = 1;
+
+			std::vector<std::thread> threads;
+			for (UInt32 i = 0; i < workers; i++)
+				threads.emplace_back(Worker, &context);
+
+			printf("Listening on %s with %d worker(s).\r\n", _options.SocketPath, (int)workers);
+			fflush(stdout);
+
+			while (!context.IsShutdown)
+			{
+				auto client = accept(context.Listener, nullptr, nullptr);
+				if (client == InvalidSocket)
+				{
+					if (context.IsShutdown)
+						break;
+
+					// out of descriptors or an aborted connection; back off instead of spinning on the listener.
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+					continue;
+				}
+
+				context.Queue.Push(client);
+			}
+
+			context.Queue.Stop();
+			for (auto& thread : threads)
+				thread.join();
+
+#ifndef _WIN32
+			CloseSocket(context.Listener);
+#endif
+			UnlinkSocketPath(_options.SocketPath);
+
+#ifdef _WIN32
+			WSACleanup();
+#endif
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017 Subramaniyan Neelagandan
+ * All Rights Reserved.
+ *
+ * All information contained herein is, and remains the property of
+ * Subramaniyan Neelagandan. The intellectual and technical concepts
+ * contained herein are proprietary to Subramaniyan Neelagandan.
+ *
+ * Limited restrictive permission is hereby granted for educational
+ * purpose(s) only and which are learning, understanding, explaining
+ * and teaching.
+ */
+
+#pragma once
+
+#include "GraphUtility.h"
+
+#include <string>
+
+namespace Graph
+{
+	namespace Server
+	{
+		/*
+		*	Wire format : one request per line, one response per line. Tokens are separated by blanks.
+		*
+		*		request		:	<COMMAND> [argument ...]\n
+		*		response		:	OK [value ...]\n  |  ERR <message>\n
+		*
+		*	A request line longer than MaxRequestLength bytes gets ERR request too long and the connection is closed.
+		*
+		*	Commands (vertex ids are zero based):
+		*		PING									OK PONG
+		*		LOAD <name> <path> [TRIANGULAR]	OK <vertices>						DIMACS binary graph or graph cache file;
+		*																			TRIANGULAR keeps it as a half matrix (TriangularGraph).
+		*		SAVE <name> <path>				OK										writes graph cache of <name> to <path>.
+		*		UNLOAD <name>						OK
+		*		LIST									OK <count> [<name>:<vertices> ...]
+		*		MAXCLIQUE <name>					OK <size> <vertex> ...
+		*		HASCLIQUE <name> <k>				OK 1 <size> <vertex> ...  |  OK 0
+		*		VERTEXCLIQUE <name> <v>			OK <size> <vertex> ...			maximum clique containing <v>.
+		*		COLOR <name> [<mode> [<tabu>]]	OK <colors> <color of vertex 0> ...	colors are one based; <mode> EXACT
+		*																			(default), DSATUR, RLF or JP (see ColoringMode), the
+		*																			heuristics then <tabu> moves per color removed.
+		*		CHROMATIC <name> [<ms>]			OK <colors> <lower bound> <color of vertex 0> ...	χ when <colors> equals
+		*																			<lower bound>; else the best within <ms>.
+		*		QUIT									closes the connection.
+		*		SHUTDOWN								OK and stops the server.
+		*/
+
+		static const size_t MaxRequestLength = 64 * 1024;
+
+		struct Options
+		{
+			Options()
+				: SocketPath(nullptr), Workers(0), Triangular(false)
+			{
+			}
+
+			const char	*SocketPath;
+			UInt32		Workers;		// 0 : number of hardware threads.
+			bool			Triangular;	// graphs loaded at startup are kept as half matrices.
+		};
+
+		class GraphStore;
+
+		// Loads _path as graph _name into _store; returns error message or nullptr.
+		// _triangular : kept as a TriangularGraph, half the memory; each query searches a dense copy.
+		// _pVertices : receives the vertex count, as the entry may be unloaded by another client before it is looked up.
+		const char* LoadGraph(GraphStore& _store, const char* _name, const char* _path, bool _triangular = false, ID* _pVertices = nullptr);
+
+		// Executes one request line against _store using _solver.
+		// Returns false when the connection is to be closed; _shutdown is set by SHUTDOWN.
+		bool ProcessRequest(GraphStore& _store, Clique::Solver& _solver, const char* _request, std::string& _response, bool& _shutdown);
+
+		GraphStore* CreateGraphStore();
+
+		void FreeGraphStore(GraphStore* _store);
+
+		// Serves requests on the Unix domain socket until SHUTDOWN, one Solver per worker; graphs are "name=path" pairs loaded at startup.
+		int Run(const Options& _options, int _graphCount, char* _graphs[]);
+	}
+}
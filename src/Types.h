@@ -13,19 +13,21 @@
 
 #pragma once
 
+#include "Platform.h"
+
 #include <stdexcept>
 
 #if (!Types_H)
 #define Types_H
 
 typedef unsigned char byte;
-typedef __int32 Int32;
-typedef __int64 Int64;
-typedef unsigned __int32 UInt32;
-typedef unsigned __int64 UInt64;
+typedef int Int32;
+typedef long long Int64;
+typedef unsigned int UInt32;
+typedef unsigned long long UInt64;
 
-#if (defined(_M_AMD64) || defined(_M_X64))
-typedef __int64 PtrInt;
+#if (defined(_M_AMD64) || defined(_M_X64) || defined(__x86_64__))
+typedef Int64 PtrInt;
 #else
 typedef long PtrInt;
 #endif
@@ -168,7 +170,7 @@ namespace Ext
 
 		void size(size_type size) { Size = size; }
 
-		void append(T& value)
+		void append(const T& value)
 		{
 #if !defined(SkipArgumentCheck)
 			if (Size == Capacity)
@@ -217,9 +219,6 @@ namespace Ext
 		T				*pList;
 		size_type	SetCount;
 		size_type	ElementsCapacity;
-	public:
-		typedef size_type size_type;
-
 	public:
 		static inline size_t GetAllocationSize(size_type elementsCapacity)
 		{
@@ -304,7 +303,7 @@ namespace Ext
 			SetCount = that.SetCount,
 			pStartIndex = that.pStartIndex,
 			ElementsCapacity = that.ElementsCapacity,
-			pList = that.pList
+			pList = that.pList;
 
 			return *this;
 		};
@@ -21,7 +21,7 @@
 
 namespace Graph
 {
-typedef unsigned __int32 ID;
+typedef UInt32 ID;
 #define INVALID_ID UINT32_MAX
 
 	struct Vertex
@@ -73,35 +73,11 @@ typedef unsigned __int32 ID;
 			Unassigned = 0xFF,
 		};
 
-		struct VariableAssignmentOverride
-		{
-			ID Variable;
-			ID Order;
-			AssignmentState State;
-			TruthValue RequiredLiteral, IsRequired;
-
-			VariableAssignmentOverride()
-				: Variable(0), Order(0), State(AssignmentState::Unassigned),
-				RequiredLiteral(TruthValue::Unassigned), IsRequired(TruthValue::Unassigned)
-			{
-			}
-
-			VariableAssignmentOverride(ID variable, AssignmentState state, ID order, TruthValue requiredLiteral, TruthValue isRequired)
-			{
-				Variable = variable;
-				State = state;
-				Order = order;
-				RequiredLiteral = requiredLiteral;
-				IsRequired = isRequired;
-			}
-		};
-
 		struct VariableAssignment
 		{
 			ID Order;
 			TruthValue Value;
 			AssignmentState State;
-			TruthValue RequiredLiteral, IsRequired;
 
 			void Set(TruthValue _value, AssignmentState _state, ID _order)
 			{
@@ -109,29 +85,6 @@ typedef unsigned __int32 ID;
 				Value = _value;
 				State = _state;
 			}
-
-			void Set(VariableAssignmentOverride& override)
-			{
-				Order = override.Order;
-				Value = TruthValue::Unassigned;
-				State = override.State;
-				RequiredLiteral = override.RequiredLiteral;
-				IsRequired = override.IsRequired;
-			}
-
-			void CopyTo(VariableAssignmentOverride& override, ID variable)
-			{
-				override.Order = Order;
-				override.Variable = variable;
-				override.State = State;
-				override.RequiredLiteral = RequiredLiteral;
-				override.IsRequired = IsRequired;
-			}
-
-			VariableAssignmentOverride ToOverride(ID variable)
-			{
-				return VariableAssignmentOverride(variable, State, Order, RequiredLiteral, IsRequired);
-			}
 		};
 
 		struct Formula
@@ -144,7 +97,7 @@ typedef unsigned __int32 ID;
 			{
 			};
 
-			Formula(ID variables, Ext::ArrayOfArray<int, ID>& clauses)
+			Formula(ID variables, const Ext::ArrayOfArray<int, ID>& clauses)
 				: Variables(variables), Clauses(clauses)
 			{
 			};
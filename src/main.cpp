@@ -12,10 +12,13 @@
  */
 
 #include "GraphUtility.h"
+#include "Benchmark.h"
+#include "Server.h"
 #include "Utility.h"
 #include "Bit.h"
 
-#include <conio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef _WIN32
 #pragma comment(lib, "Kernel32.lib")
@@ -31,18 +34,191 @@
 #else
 	void LogMessage(const char* message)
 	{
-		OutputDebugStringA(message);
+		fputs(message, stderr);
 	}
 #endif
 
+static void PrintAllocationReport()
+{
+	auto options = GetAllocationOptions();
+	auto statistics = GetAllocationStatistics();
+
+	printf("allocator : requested %s%s, obtained %s (heap %llu, aligned %llu, thp %llu, hugetlb %llu, lock failures %llu)\r\n",
+		GetAllocationBackendName(options.Backend), options.Lock ? ",lock" : "",
+		(statistics.LargeAllocations == 0) ? "-" : GetAllocationBackendName(statistics.LastBackend),
+		statistics.Allocations[0], statistics.Allocations[1], statistics.Allocations[2], statistics.Allocations[3], statistics.LockFailures);
+}
+
+static void PrintProgress(const Graph::Clique::Progress& _progress, void*)
+{
+	char eta[32] = "?";
+	if (_progress.EtaSeconds >= 0)
+		sprintf_s(eta, sizeof(eta), "%.0fs", _progress.EtaSeconds);
+
+	printf("progress : %6.2f%% incumbent %u nodes %llu (%.0f/s) depth %u elapsed %.0fs eta %s\r\n",
+		100 * _progress.Fraction, (unsigned)_progress.Incumbent, _progress.Nodes, _progress.NodesPerSecond, (unsigned)_progress.Depth, _progress.ElapsedSeconds, eta);
+	fflush(stdout);
+}
 
 int main(int argc, char* argv[])
 {
 	std::string path;
 	Ext::Array<Graph::Vertex> graph;
+	bool reportAllocator = false;
 
 	Graph::SetTraceMessageHandler(LogMessage);
 
+	// Clique -allocator <heap|aligned|thp|hugetlb[,lock][,min=<bytes>]> ...
+	if ((argc >= 3) && (strcmp(argv[1], "-allocator") == 0))
+	{
+		if (!SetAllocationOptions(argv[2]))
+		{
+			printf("Unknown allocator %s\r\n", argv[2]);
+			return 1;
+		}
+
+		reportAllocator = true;
+		argv[2] = argv[0];
+		argc -= 2;
+		argv += 2;
+	}
+
+	// Clique [-allocator ...] -budget <MB> ... : hard limit of the solver memory.
+	size_t budget = 0;
+	if ((argc >= 3) && (strcmp(argv[1], "-budget") == 0))
+	{
+		budget = (size_t)strtoull(argv[2], nullptr, 10) << 20;
+		if (budget == 0)
+		{
+			printf("Invalid budget %s\r\n", argv[2]);
+			return 1;
+		}
+
+		Graph::Clique::SetMemoryBudget(budget);
+		argv[2] = argv[0];
+		argc -= 2;
+		argv += 2;
+	}
+
+	// Clique [-allocator ...] [-budget ...] -counters <json|csv>[,depth] ... : exports the search counters after the run.
+	const char* counterFormat = nullptr;
+	if ((argc >= 3) && (strcmp(argv[1], "-counters") == 0))
+	{
+		counterFormat = argv[2];
+		if ((strncmp(counterFormat, "json", 4) != 0) && (strncmp(counterFormat, "csv", 3) != 0))
+		{
+			printf("Unknown counter format %s\r\n", argv[2]);
+			return 1;
+		}
+
+		Graph::Clique::SetCounterDepthBreakdown(strstr(counterFormat, ",depth") != nullptr);
+		argv[2] = argv[0];
+		argc -= 2;
+		argv += 2;
+	}
+
+	// Clique [...] -profile [<sampling interval>] ... : prints the stage timers and histograms of the search after the run.
+	bool profile = false;
+	if ((argc >= 2) && (strcmp(argv[1], "-profile") == 0))
+	{
+		int skip = 1;
+		UInt32 interval = 16;
+		if ((argc >= 4) && (strspn(argv[2], "0123456789") == strlen(argv[2])))
+		{
+			interval = (UInt32)atoi(argv[2]);
+			skip = 2;
+		}
+
+		profile = true;
+		Graph::Clique::SetProfiling(true, interval);
+		argv[skip] = argv[0];
+		argc -= skip;
+		argv += skip;
+	}
+
+	// Clique [...] -order <none|degeneracy|degree|bandwidth> ... : renumbers the vertices before the search (PackVertices).
+	if ((argc >= 3) && (strcmp(argv[1], "-order") == 0))
+	{
+		static const char* orders[] = { "none", "degeneracy", "degree", "bandwidth" };
+		int order = 0;
+
+		while ((order < 4) && (strcmp(argv[2], orders[order]) != 0))
+			order++;
+
+		if (order == 4)
+		{
+			printf("Unknown vertex order %s\r\n", argv[2]);
+			return 1;
+		}
+
+		Graph::Clique::SetVertexOrder((Graph::VertexOrder)order);
+		argv[2] = argv[0];
+		argc -= 2;
+		argv += 2;
+	}
+
+	// Clique [...] -progress <seconds> ... : prints the estimated progress of the search at the interval.
+	UInt32 progressInterval = 0;
+	if ((argc >= 3) && (strcmp(argv[1], "-progress") == 0))
+	{
+		progressInterval = (UInt32)(atof(argv[2]) * 1000);
+		if (progressInterval == 0)
+		{
+			printf("Invalid progress interval %s\r\n", argv[2]);
+			return 1;
+		}
+
+		argv[2] = argv[0];
+		argc -= 2;
+		argv += 2;
+	}
+
+	// Clique -server <socket> [-workers N] [-triangular] [name=path ...]
+	if ((argc >= 3) && (strcmp(argv[1], "-server") == 0))
+	{
+		Graph::Server::Options options;
+		int i = 3;
+
+		options.SocketPath = argv[2];
+		if ((argc >= (i + 2)) && (strcmp(argv[i], "-workers") == 0))
+		{
+			options.Workers = (UInt32)atoi(argv[i + 1]);
+			i += 2;
+		}
+
+		if ((argc >= (i + 1)) && (strcmp(argv[i], "-triangular") == 0))
+		{
+			options.Triangular = true;
+			i++;
+		}
+
+		Graph::SetTraceMessageHandler(nullptr);
+
+		return Graph::Server::Run(options, argc - i, argv + i);
+	}
+
+	// Clique -bench <pool|dimacs|kernels> [arguments]
+	if ((argc >= 3) && (strcmp(argv[1], "-bench") == 0))
+	{
+		if (strcmp(argv[2], "pool") == 0)
+		{
+			auto result = Graph::Benchmark::RunPool(argc - 3, argv + 3);
+			if (reportAllocator)
+				PrintAllocationReport();
+
+			return result;
+		}
+
+		if (strcmp(argv[2], "dimacs") == 0)
+			return Graph::Benchmark::RunDimacs(argc - 3, argv + 3);
+
+		if (strcmp(argv[2], "kernels") == 0)
+			return Graph::Benchmark::RunKernels(argc - 3, argv + 3);
+
+		printf("Unknown benchmark %s\r\n", argv[2]);
+		return 1;
+	}
+
 	if (argc == 2)
 	{
 		path = std::string(argv[1]);
@@ -50,10 +226,42 @@ int main(int argc, char* argv[])
 		graph = Graph::ReadDIMACSGraph(path.c_str());
 		if (graph.size() > 0)
 		{
-			auto cliqueSize = Graph::FindClique(graph);
+			decltype(Graph::Vertex::Id) cliqueSize;
+			size_t highWater = 0;
+			std::string counters, report;
+
+			{
+				Graph::Clique::Solver solver;
+
+				solver.SetTraceStatistics(progressInterval == 0);
+				if (progressInterval > 0)
+					solver.SetProgressHandler(PrintProgress, nullptr, progressInterval);
+
+				cliqueSize = solver.FindClique(graph);
+				highWater = solver.MemoryHighWater();
+
+				if (counterFormat != nullptr)
+					counters = solver.ExportCounters((strncmp(counterFormat, "csv", 3) == 0) ? Graph::Clique::CounterFormat::Csv : Graph::Clique::CounterFormat::Json, path.c_str());
+
+				if (profile)
+					report = solver.ReportProfile();
+			}
+
 			Graph::FreeGraph(graph);
 
 			printf("\r\n%d\r\n", cliqueSize);
+
+			if (budget > 0)
+				printf("memory : high-water %llu bytes, budget %llu bytes\r\n", (UInt64)highWater, (UInt64)budget);
+
+			if (counterFormat != nullptr)
+				printf("%s", counters.c_str());
+
+			if (profile)
+				printf("%s", report.c_str());
+
+			if (reportAllocator)
+				PrintAllocationReport();
 		}
 		else
 		{